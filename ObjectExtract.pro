@@ -9,15 +9,56 @@ CONFIG += c++17
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
 SOURCES += \
+    contourscan.cpp \
     cvfunction.cpp \
+    detectorregistry.cpp \
+    displaycache.cpp \
+    edgekernel.cpp \
+    facedetector.cpp \
+    facestream.cpp \
+    fftmatcher.cpp \
+    grabcutsegmenter.cpp \
+    grabcutsession.cpp \
+    hammingmatcher.cpp \
+    imageframe.cpp \
     imagepool.cpp \
+    jobrunner.cpp \
     main.cpp \
-    mainwindow.cpp
+    mainwindow.cpp \
+    objecttracker.cpp \
+    preparedtemplate.cpp \
+    referencelibrary.cpp \
+    templatematcher.cpp \
+    threadpool.cpp \
+    tiledsource.cpp \
+    traceprobe.cpp \
+    trackpipeline.cpp
 
 HEADERS += \
+    contourscan.h \
     cvfunction.h \
+    detectorregistry.h \
+    displaycache.h \
+    edgekernel.h \
+    facedetector.h \
+    facestream.h \
+    fftmatcher.h \
+    grabcutsegmenter.h \
+    grabcutsession.h \
+    hammingmatcher.h \
+    imageframe.h \
     imagepool.h \
-    mainwindow.h
+    jobrunner.h \
+    mainwindow.h \
+    objecttracker.h \
+    preparedtemplate.h \
+    referencelibrary.h \
+    spscqueue.h \
+    templatematcher.h \
+    threadpool.h \
+    tiledsource.h \
+    traceprobe.h \
+    trackpipeline.h
 
 FORMS += \
     mainwindow.ui
@@ -0,0 +1,64 @@
+QT       += core
+QT       -= gui
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+TARGET = ObjectExtractBench
+
+SOURCES += \
+    benchcontour.cpp \
+    benchedge.cpp \
+    benchface.cpp \
+    benchgrabcut.cpp \
+    benchhamming.cpp \
+    benchmain.cpp \
+    benchpool.cpp \
+    benchsuite.cpp \
+    benchtemplate.cpp \
+    contourscan.cpp \
+    cvfunction.cpp \
+    detectorregistry.cpp \
+    edgekernel.cpp \
+    facedetector.cpp \
+    fftmatcher.cpp \
+    grabcutsegmenter.cpp \
+    grabcutsession.cpp \
+    hammingmatcher.cpp \
+    imageframe.cpp \
+    imagepool.cpp \
+    objecttracker.cpp \
+    preparedtemplate.cpp \
+    templatematcher.cpp \
+    threadpool.cpp \
+    tiledsource.cpp \
+    traceprobe.cpp
+
+HEADERS += \
+    benchmark.h \
+    contourscan.h \
+    cvfunction.h \
+    detectorregistry.h \
+    edgekernel.h \
+    facedetector.h \
+    fftmatcher.h \
+    grabcutsegmenter.h \
+    grabcutsession.h \
+    hammingmatcher.h \
+    imageframe.h \
+    imagepool.h \
+    objecttracker.h \
+    preparedtemplate.h \
+    templatematcher.h \
+    threadpool.h \
+    tiledsource.h \
+    traceprobe.h
+
+win32 {
+    INCLUDEPATH += C:\OpenCV\build\include
+    LIBS += C:\OpenCV\build\x64\vc16\lib\opencv_world4110.lib
+}
+unix {
+    CONFIG += link_pkgconfig
+    PKGCONFIG += opencv4
+}
@@ -0,0 +1,61 @@
+QT       += core
+QT       -= gui
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+TARGET = ObjectExtractCli
+
+SOURCES += \
+    batchpipeline.cpp \
+    climain.cpp \
+    contourscan.cpp \
+    cvfunction.cpp \
+    detectorregistry.cpp \
+    edgekernel.cpp \
+    facedetector.cpp \
+    facestream.cpp \
+    fftmatcher.cpp \
+    grabcutsegmenter.cpp \
+    grabcutsession.cpp \
+    imageframe.cpp \
+    preparedtemplate.cpp \
+    streamrunner.cpp \
+    templatematcher.cpp \
+    threadpool.cpp \
+    tiledsource.cpp \
+    traceprobe.cpp
+
+HEADERS += \
+    batchpipeline.h \
+    boundedqueue.h \
+    contourscan.h \
+    cvfunction.h \
+    detectorregistry.h \
+    edgekernel.h \
+    facedetector.h \
+    facestream.h \
+    fftmatcher.h \
+    grabcutsegmenter.h \
+    grabcutsession.h \
+    imageframe.h \
+    preparedtemplate.h \
+    streamrunner.h \
+    templatematcher.h \
+    threadpool.h \
+    tiledsource.h \
+    traceprobe.h
+
+# Default rules for deployment.
+qnx: target.path = /tmp/$${TARGET}/bin
+else: unix:!android: target.path = /opt/$${TARGET}/bin
+!isEmpty(target.path): INSTALLS += target
+
+win32 {
+    INCLUDEPATH += C:\OpenCV\build\include
+    LIBS += C:\OpenCV\build\x64\vc16\lib\opencv_world4110.lib
+}
+unix {
+    CONFIG += link_pkgconfig
+    PKGCONFIG += opencv4
+}
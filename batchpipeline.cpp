@@ -0,0 +1,375 @@
+#include "batchpipeline.h"
+#include <QFile>
+#include <QTextStream>
+#include <QDir>
+#include <QFileInfo>
+#include <QHash>
+#include <QSet>
+#include <chrono>
+#include <thread>
+
+static int resolveWorkers(int workers)
+{
+    if (workers > 0) return workers;
+    int cores = static_cast<int>(std::thread::hardware_concurrency());
+    return cores > 0 ? cores : 1;
+}
+
+static size_t resolveDepth(const BatchOptions &options)
+{
+    return options.queueDepth > 0 ? options.queueDepth : 2 * resolveWorkers(options.workers);
+}
+
+BatchPipeline::BatchPipeline(const BatchOptions &options)
+    : options(options)
+    , decoded(resolveDepth(options))
+    , processed(resolveDepth(options))
+{
+    this->options.workers = resolveWorkers(options.workers);
+}
+
+BatchPipeline::~BatchPipeline() {}
+
+QStringList BatchPipeline::outputStems(const QStringList &inputs)
+{
+    QStringList dirs;
+    for (const QString &path : inputs) dirs << QFileInfo(path).absolutePath();
+
+    QString root = dirs.isEmpty() ? QString() : dirs.first();
+    for (const QString &dir : dirs)
+    {
+        while (!root.isEmpty() && dir != root && !dir.startsWith(root.endsWith('/') ? root : root + '/'))
+        {
+            QString parent = QFileInfo(root).path();
+            root = parent == root ? QString() : parent;
+        }
+    }
+
+    QStringList stems;
+    QHash<QString, int> counts;
+    for (int i = 0; i < inputs.size(); i++)
+    {
+        // 没有公共上级目录（Windows 下位于不同盘符）时不镜像，重名由下面的扩展名和报错处理
+        QString relative = root.isEmpty() ? QString(".") : QDir(root).relativeFilePath(dirs[i]);
+        QString stem = QFileInfo(inputs[i]).completeBaseName();
+        if (relative != ".") stem = relative + '/' + stem;
+        stems << stem;
+        counts[stem.toLower()]++;  // Windows 下文件名不区分大小写
+    }
+
+    QSet<QString> used;
+    for (int i = 0; i < inputs.size(); i++)
+    {
+        QString stem = stems[i];
+        if (counts[stem.toLower()] > 1)
+        {
+            stem += '_' + QFileInfo(inputs[i]).suffix();
+            std::cerr << "Warning: " << inputs[i].toStdString() << " shares its name with another input, writing "
+                      << stem.toStdString() << "_*" << std::endl;
+        }
+        if (used.contains(stem.toLower()))
+            stem.clear();
+        else
+            used.insert(stem.toLower());
+        stems[i] = stem;
+    }
+    return stems;
+}
+
+BatchStats BatchPipeline::run()
+{
+    BatchStats stats;
+    stats.total = options.inputs.size();
+
+    if (options.operation == BATCH_TEMPLATE)
+    {
+        ref = ImageFrame::load(options.refPath.toStdString());
+        if (ref.empty())
+        {
+            std::cerr << "Error: Failed to load reference " << options.refPath.toStdString() << std::endl;
+            stats.failed = stats.total;
+            return stats;
+        }
+        refTemplate.reset(ref);
+    }
+
+    if (!QDir().mkpath(options.outputDir))
+    {
+        std::cerr << "Error: Could not create output directory " << options.outputDir.toStdString() << std::endl;
+        stats.failed = stats.total;
+        return stats;
+    }
+
+    // 子目录在编码线程开始前一次建好
+    stems = outputStems(options.inputs);
+    QDir out(options.outputDir);
+    for (const QString &stem : stems)
+    {
+        QString dir = QFileInfo(stem).path();
+        if (!stem.isEmpty() && dir != "." && !out.mkpath(dir))
+            std::cerr << "Error: Could not create output directory " << out.filePath(dir).toStdString() << std::endl;
+    }
+
+    // 解码与编码以IO为主，各分配四分之一的线程；处理阶段占满全部核心
+    int processors = options.workers;
+    int decoders = std::max(1, processors / 4);
+    int encoders = std::max(1, processors / 4);
+    decodersLeft = decoders;
+    processorsLeft = processors;
+
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < decoders; i++)   threads.emplace_back(&BatchPipeline::decodeStage, this);
+    for (int i = 0; i < processors; i++) threads.emplace_back(&BatchPipeline::processStage, this);
+    for (int i = 0; i < encoders; i++)   threads.emplace_back(&BatchPipeline::encodeStage, this);
+    for (std::thread &t : threads) t.join();
+
+    stats.processed = doneCount;
+    stats.failed = failCount;
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return stats;
+}
+
+void BatchPipeline::decodeStage()
+{
+    for (;;)
+    {
+        int index = nextInput++;
+        if (index >= options.inputs.size()) break;
+
+        Item item;
+        item.index = index;
+        item.path = options.inputs.at(index);
+        if (stems[index].isEmpty())
+        {
+            fail(item.path, "listed more than once, outputs would overwrite each other");
+            continue;
+        }
+        if (useTiled(item.path))
+        {
+            // 超大图不在这里解码，避免整图进入内存
+            item.tiled = true;
+            if (!decoded.push(std::move(item))) break;
+            continue;
+        }
+        // 保持 imread 的 BGR 顺序，灰度平面由处理阶段按需计算，编码时也不必再转回 BGR
+        item.image = ImageFrame::load(item.path.toStdString());
+        if (item.image.empty())
+        {
+            fail(item.path, "failed to decode");
+            continue;
+        }
+
+        if (!decoded.push(std::move(item))) break;
+    }
+
+    // 最后一个解码线程退出时关闭队列，通知下游不会再有新数据
+    if (--decodersLeft == 0) decoded.close();
+}
+
+void BatchPipeline::processStage()
+{
+    // 每个处理线程一个匹配器，同尺寸的源图复用 DFT 计划和频域缓冲
+    FftMatcher matcher;
+    Item item;
+    while (decoded.pop(item))
+    {
+        bool ok = false;
+        try
+        {
+            ok = process(item, matcher);
+        }
+        catch (const cv::Exception &e)
+        {
+            std::cerr << "Error: " << e.what() << std::endl;
+        }
+
+        if (!ok)
+        {
+            fail(item.path, "processing failed");
+            continue;
+        }
+        item.image = ImageFrame();
+        processed.push(std::move(item));
+    }
+
+    if (--processorsLeft == 0) processed.close();
+}
+
+void BatchPipeline::encodeStage()
+{
+    Item item;
+    while (processed.pop(item))
+    {
+        QString baseName = stems[item.index];
+        QDir out(options.outputDir);
+
+        bool ok = true;
+        if (options.saveMarked && !item.marked.empty())
+            ok &= ImageFrame::write(out.filePath(baseName + "_mark." + options.format).toStdString(), item.marked, item.order);
+        if (!item.cut.empty())
+            ok &= ImageFrame::write(out.filePath(baseName + "_cut." + options.format).toStdString(), item.cut, item.order);
+        if (options.matchThreshold >= 0)
+        {
+            // 每个匹配一行：x,y,width,height,score
+            QFile csv(out.filePath(baseName + "_matches.csv"));
+            ok &= csv.open(QIODevice::WriteOnly | QIODevice::Text);
+            QTextStream stream(&csv);
+            for (const MatchCandidate &m : item.matches)
+                stream << m.loc.x << ',' << m.loc.y << ',' << ref.cols() << ',' << ref.rows() << ',' << m.score << '\n';
+        }
+
+        if (options.allFaces)
+        {
+            // 每张人脸一个剪裁文件；csv 每行：x,y,width,height,眼睛数,随后每只眼睛 x,y,width,height
+            QFile csv(out.filePath(baseName + "_faces.csv"));
+            ok &= csv.open(QIODevice::WriteOnly | QIODevice::Text);
+            QTextStream stream(&csv);
+            for (size_t i = 0; i < item.faces.size(); i++)
+            {
+                const FaceResult &face = item.faces[i];
+                ok &= ImageFrame::write(out.filePath(QString("%1_face%2.%3").arg(baseName).arg(i).arg(options.format)).toStdString(),
+                                        face.crop, item.order);
+
+                stream << face.face.x << ',' << face.face.y << ',' << face.face.width << ',' << face.face.height
+                       << ',' << face.eyes.size();
+                for (const Rect &eye : face.eyes)
+                    stream << ',' << eye.x << ',' << eye.y << ',' << eye.width << ',' << eye.height;
+                stream << '\n';
+            }
+        }
+
+        if (!ok)
+        {
+            fail(item.path, "failed to encode");
+            continue;
+        }
+
+        int done = ++doneCount;
+        if (done % 100 == 0 || done == options.inputs.size())
+            std::cerr << done << "/" << options.inputs.size() << " images done" << std::endl;
+    }
+}
+
+bool BatchPipeline::useTiled(const QString &path) const
+{
+    bool tiledOp = options.operation == BATCH_EDGE ||
+                   (options.operation == BATCH_TEMPLATE && options.matchThreshold < 0);
+    if (options.tiledMegapixels <= 0 || !tiledOp) return false;
+
+    Size size;
+    int channels;
+    return TiledImageSource::probe(path, size, channels) &&
+           static_cast<double>(size.width) * size.height >= options.tiledMegapixels * 1e6;
+}
+
+bool BatchPipeline::processTiled(Item &item) const
+{
+    TiledImageSource source;
+    if (!source.open(item.path)) return false;
+
+    // 整图不在内存中，不输出标注图；边缘图直接写到输出目录
+    TiledSourceOptions tiled;
+    item.order = ORDER_RGB;  // readRGB 的剪裁
+    if (options.operation == BATCH_TEMPLATE)
+    {
+        item.cut = CVFunction::templateSearch(source, refTemplate, options.method, tiled);
+    }
+    else
+    {
+        // 与其他输出使用相同的前缀，同名输入的边缘图不会互相覆盖
+        QString edgePath = QDir(options.outputDir).filePath(stems[item.index] + "_edges.pgm");
+        item.cut = CVFunction::edgeDetection(source, edgePath, tiled);
+    }
+    return !item.cut.empty();
+}
+
+bool BatchPipeline::process(Item &item, FftMatcher &matcher) const
+{
+    if (item.tiled) return processTiled(item);
+
+    const ImageFrame &src = item.image;
+    item.marked = src.mat().clone();
+    item.order = src.order();
+
+    switch (options.operation)
+    {
+    case BATCH_TEMPLATE:
+        if (ref.cols() > src.cols() || ref.rows() > src.rows())
+        {
+            std::cerr << "Error: Template image is larger than source image!" << std::endl;
+            return false;
+        }
+        if (options.matchThreshold >= 0)
+        {
+            MultiMatchOptions multi;
+            multi.threshold = options.matchThreshold;
+            item.cut = CVFunction::templateSearchAll(src, ref, item.marked, options.method, multi, item.matches);
+        }
+        else if (options.tileThreads > 0)
+        {
+            TiledOptions tiled;
+            tiled.threads = options.tileThreads;
+            tiled.tileRows = options.tileRows;
+            item.cut = CVFunction::templateSearch(src, ref, item.marked, options.method, tiled);
+        }
+        else if (options.pyramidLevels > 1)
+        {
+            PyramidOptions pyramid;
+            pyramid.levels = options.pyramidLevels;
+            pyramid.candidates = options.pyramidCandidates;
+            item.cut = CVFunction::templateSearch(src, ref, item.marked, options.method, pyramid);
+        }
+        else
+        {
+            if (matcher.empty()) matcher.reset(refTemplate, src.size());
+            item.cut = CVFunction::templateSearch(src, matcher, item.marked, options.method);
+        }
+        break;
+    case BATCH_FACE:
+        if (options.allFaces)
+        {
+            FaceOptions face;
+            face.workingSize = options.faceWorkingSize;
+            // 多个处理线程时并行已经发生在图像级别
+            face.threads = options.workers == 1 ? 0 : 1;
+            item.faces = CVFunction::faceSearchAll(src, item.marked, face);
+        }
+        else if (options.faceWorkingSize > 0)
+        {
+            FaceOptions face;
+            face.workingSize = options.faceWorkingSize;
+            item.cut = CVFunction::faceSearch(src, item.marked, face);
+        }
+        else
+        {
+            item.cut = CVFunction::faceSearch(src, item.marked);
+        }
+        break;
+    case BATCH_EDGE:
+        item.cut = CVFunction::edgeDetection(src, item.marked, options.edgeKernel);
+        break;
+    case BATCH_GRABCUT:
+        if (options.grabcutScale < 1.0)
+        {
+            GrabCutOptions grabcut;
+            grabcut.scale = options.grabcutScale;
+            grabcut.bandWidth = options.grabcutBand;
+            grabcut.threads = options.workers == 1 ? 0 : 1;
+            item.cut = CVFunction::grabcutForegroundExtraction(src, item.marked, grabcut);
+        }
+        else
+        {
+            item.cut = CVFunction::grabcutForegroundExtraction(src, item.marked);
+        }
+        break;
+    }
+    return true;
+}
+
+void BatchPipeline::fail(const QString &path, const char *reason)
+{
+    ++failCount;
+    std::cerr << "Error: " << path.toStdString() << ": " << reason << std::endl;
+}
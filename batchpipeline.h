@@ -0,0 +1,107 @@
+#ifndef BATCHPIPELINE_H
+#define BATCHPIPELINE_H
+
+#include "cvfunction.h"
+#include "templatematcher.h"
+#include "preparedtemplate.h"
+#include "fftmatcher.h"
+#include "tiledsource.h"
+#include "facedetector.h"
+#include "grabcutsegmenter.h"
+#include "boundedqueue.h"
+#include <QStringList>
+#include <atomic>
+
+enum BatchOperation
+{
+    BATCH_TEMPLATE,
+    BATCH_FACE,
+    BATCH_EDGE,
+    BATCH_GRABCUT,
+};
+
+struct BatchOptions
+{
+    BatchOperation operation = BATCH_EDGE;
+    QStringList inputs;                 // 待处理的图片路径
+    QString outputDir;
+    QString refPath;                    // 模板匹配使用的参考图
+    Method method = Method::TM_SQDIFF;
+    int pyramidLevels = 1;              // 大于1时模板匹配使用金字塔模式
+    int pyramidCandidates = 4;
+    int tileThreads = 0;                // 大于0时模板匹配按条带多线程执行
+    int tileRows = 0;
+    double matchThreshold = -1;         // 不小于0时返回所有高于该得分的匹配
+    int faceWorkingSize = 0;            // 大于0时人脸在长边缩放到该像素数的图像上检测
+    bool allFaces = false;              // 导出全部人脸及其眼睛位置
+    int edgeKernel = 3;
+    double grabcutScale = 1.0;          // 小于1时GrabCut先在缩小的图像上分割，再细化边界
+    int grabcutBand = 8;                // 边界细化的带宽（原始分辨率像素）
+    double tiledMegapixels = 100;       // PPM/PGM 输入不小于该像素数（百万）时，模板匹配和边缘检测映射文件分块处理，0 表示不分块
+    int workers = 0;                    // 处理线程数，0 表示使用全部核心
+    int queueDepth = 0;                 // 每级队列容量，0 表示 2 倍处理线程数
+    QString format = "png";
+    bool saveMarked = true;             // 是否同时导出标注图
+};
+
+struct BatchStats
+{
+    int total = 0;
+    int processed = 0;
+    int failed = 0;
+    double seconds = 0;
+};
+
+// 无界面批处理流水线：解码 -> 处理 -> 编码，三级之间用有界队列连接
+class BatchPipeline
+{
+public:
+    explicit BatchPipeline(const BatchOptions &options);
+    ~BatchPipeline();
+
+    BatchStats run();
+
+    // 各输入的输出前缀（相对输出目录，不含后缀）：输入所在目录相对全部输入的公共上级目录在输出目录下镜像，
+    // 全部输入位于同一目录时即为原来的文件名。同一目录中只有扩展名不同的文件（a.png 与 a.jpg）
+    // 在前缀后追加扩展名；同一文件重复列出时无法区分，返回空字符串，由调用者报错。
+    // 前缀可能带子目录，由调用者在输出目录下创建
+    static QStringList outputStems(const QStringList &inputs);
+
+private:
+    struct Item
+    {
+        int index = -1;
+        QString path;
+        bool tiled = false;  // 不解码，处理时映射文件分块运行
+        ImageFrame image;                 // 解码得到的 BGR 图像，不转换
+        ChannelOrder order = ORDER_BGR;   // marked、cut 和人脸剪裁的通道顺序，分块处理的剪裁为 RGB
+        Mat marked;  // 标注结果
+        Mat cut;     // 剪裁结果
+        std::vector<MatchCandidate> matches;
+        std::vector<FaceResult> faces;
+    };
+
+    void decodeStage();
+    void processStage();
+    void encodeStage();
+    bool useTiled(const QString &path) const;
+    bool process(Item &item, FftMatcher &matcher) const;
+    bool processTiled(Item &item) const;
+    void fail(const QString &path, const char *reason);
+
+    BatchOptions options;
+    QStringList stems;  // 各输入的输出前缀，run() 开始时确定，保证不同输入的输出互不覆盖
+    ImageFrame ref;
+    PreparedTemplate refTemplate;  // 所有源图共用，模板频谱只计算一次
+
+    BoundedQueue<Item> decoded;
+    BoundedQueue<Item> processed;
+
+    std::atomic<int> nextInput{0};
+    std::atomic<int> decodersLeft{0};
+    std::atomic<int> processorsLeft{0};
+    std::atomic<int> doneCount{0};
+    std::atomic<int> failCount{0};
+};
+
+#endif // BATCHPIPELINE_H
@@ -0,0 +1,71 @@
+#include "benchmark.h"
+#include "contourscan.h"
+#include <iomanip>
+#include <iostream>
+
+// 噪声图的 Canny 结果，含大量细碎轮廓；再放一个实心块作为最大轮廓
+static Mat makeEdges(Size size, RNG &rng)
+{
+    Mat gray(size, CV_8UC1);
+    rng.fill(gray, RNG::UNIFORM, 0, 256);
+    GaussianBlur(gray, gray, Size(3, 3), 0);
+    rectangle(gray, Rect(size.width / 4, size.height / 4, size.width / 3, size.height / 3), Scalar(255), FILLED);
+    Mat edges;
+    Canny(gray, edges, 50, 150);
+    return edges;
+}
+
+// 原实现：保存全部轮廓后逐个计算面积
+static size_t referenceLargest(const Mat &binary, std::vector<Point> &largest, Rect &bbox)
+{
+    std::vector<std::vector<Point>> contours;
+    findContours(binary, contours, RETR_EXTERNAL, CHAIN_APPROX_SIMPLE);
+    double maxArea = 0;
+    int maxIdx = 0;
+    size_t points = 0;
+    for (int i = 0; i < contours.size(); i++)
+    {
+        points += contours[i].size();
+        double area = contourArea(contours[i]);
+        if (area > maxArea)
+        {
+            maxArea = area;
+            maxIdx = i;
+        }
+    }
+    largest = contours.empty() ? std::vector<Point>() : contours[maxIdx];
+    bbox = contours.empty() ? Rect() : boundingRect(largest);
+    return points;
+}
+
+int benchContour(const QStringList &args)
+{
+    std::vector<Size> sizes = {Size(640, 480), Size(1920, 1080), Size(3840, 2160)};
+    int repeats = args.isEmpty() ? 10 : std::max(1, args.first().toInt());
+
+    std::cout << std::setw(12) << "size" << std::setw(14) << "stored pts" << std::setw(14) << "reference(ms)"
+              << std::setw(10) << "scan(ms)" << std::setw(10) << "speedup" << std::setw(10) << "identical" << std::endl;
+
+    RNG rng(0xc047);
+    bool ok = true;
+    for (Size size : sizes)
+    {
+        Mat edges = makeEdges(size, rng);
+        std::vector<Point> expected, scanned;
+        Rect expectedBox, scannedBox;
+        size_t points = 0;
+        double refTime = medianMillis(repeats, [&] { points = referenceLargest(edges, expected, expectedBox); });
+        double scanTime = medianMillis(repeats, [&] {
+            if (!ContourScan::largestExternal(edges, scanned, nullptr, &scannedBox)) scannedBox = Rect();
+        });
+
+        bool same = expected == scanned && expectedBox == scannedBox;
+        ok &= same;
+        std::cout << std::setw(12) << (std::to_string(size.width) + "x" + std::to_string(size.height))
+                  << std::setw(14) << (std::to_string(points) + "/" + std::to_string(scanned.size()))
+                  << std::fixed << std::setprecision(2) << std::setw(14) << refTime << std::setw(10) << scanTime
+                  << std::setw(9) << refTime / scanTime << "x" << std::setw(10) << (same ? "yes" : "NO") << std::endl;
+    }
+    if (!ok) std::cerr << "Error: streaming contour scan differs from findContours" << std::endl;
+    return ok ? 0 : 1;
+}
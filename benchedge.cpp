@@ -0,0 +1,117 @@
+#include "benchmark.h"
+#include "edgekernel.h"
+#include "imageframe.h"
+#include <iomanip>
+#include <iostream>
+
+// 确定性的测试图：渐变背景上叠加随机图形和噪声
+static Mat makeScene(Size size, RNG &rng)
+{
+    Mat img(size, CV_8UC3);
+    for (int y = 0; y < size.height; y++)
+    {
+        Vec3b *row = img.ptr<Vec3b>(y);
+        for (int x = 0; x < size.width; x++)
+            row[x] = Vec3b(static_cast<uchar>(x * 255 / size.width), static_cast<uchar>(y * 255 / size.height), 128);
+    }
+    for (int i = 0; i < 60; i++)
+    {
+        Scalar color(rng.uniform(0, 256), rng.uniform(0, 256), rng.uniform(0, 256));
+        Point center(rng.uniform(0, size.width), rng.uniform(0, size.height));
+        circle(img, center, rng.uniform(4, size.width / 8), color, FILLED);
+        rectangle(img, Rect(rng.uniform(0, size.width), rng.uniform(0, size.height), rng.uniform(8, size.width / 6),
+                            rng.uniform(8, size.height / 6)), color, rng.uniform(1, 6));
+    }
+    Mat noise(size, CV_8UC3);
+    rng.fill(noise, RNG::NORMAL, 0, 8);
+    add(img, noise, img);
+    return img;
+}
+
+// CVFunction::edgeDetection 原先的逐步实现
+static void referenceEdges(const Mat &rgb, Mat &out)
+{
+    Mat gray, gx, gy, ax, ay, magnitude;
+    cvtColor(rgb, gray, COLOR_RGB2GRAY);
+    Sobel(gray, gx, CV_32F, 1, 0, 3);
+    Sobel(gray, gy, CV_32F, 0, 1, 3);
+    convertScaleAbs(gx, ax);
+    convertScaleAbs(gy, ay);
+    addWeighted(ax, 0.5, ay, 0.5, 0, magnitude);
+    Canny(magnitude, out, 50, 150);
+}
+
+// 在计数分配器下执行一次 body，输出为空的 Mat 时其分配也计入
+struct Allocations
+{
+    int buffers = 0;           // 整幅图像大小的缓冲数（不限类型）
+    double bytesPerPixel = 0;  // 全部分配的字节数按像素数平均
+};
+
+static Allocations countAllocations(Size size, const std::function<void()> &body)
+{
+    CountingAllocator counter(size);
+    MatAllocator *previous = Mat::getDefaultAllocator();
+    Mat::setDefaultAllocator(&counter);
+    body();
+    Mat::setDefaultAllocator(previous);
+
+    Allocations a;
+    a.buffers = counter.frames;
+    a.bytesPerPixel = static_cast<double>(counter.bytes) / size.area();
+    return a;
+}
+
+// 对比逐步实现与融合实现的耗时和整图缓冲。缓冲数和每像素字节数由计数分配器实测，
+// 不含 OpenCV 内部用 AutoBuffer 分配的行缓冲。一致性按 CVFunction::edgeDetection 的三种输入检查：
+// RGB 图在条带内转换、BGR 图按 grayCode 转换、已缓存的灰度平面直接读取
+int benchEdge(const QStringList &args)
+{
+    std::vector<Size> sizes = {Size(640, 480), Size(1920, 1080), Size(3840, 2160)};
+    int repeats = args.isEmpty() ? 10 : std::max(1, args.first().toInt());
+
+    std::cout << std::setw(12) << "size" << std::setw(14) << "reference(ms)" << std::setw(10) << "fused(ms)"
+              << std::setw(10) << "speedup" << std::setw(12) << "ref bufs" << std::setw(10) << "ref B/px"
+              << std::setw(12) << "fused bufs" << std::setw(10) << "fused B/px"
+              << std::setw(6) << "rgb" << std::setw(6) << "bgr" << std::setw(6) << "gray" << std::endl;
+
+    RNG rng(0xed9e);
+    bool ok = true;
+    for (Size size : sizes)
+    {
+        Mat rgb = makeScene(size, rng);
+        Mat expected, fused;
+        double refTime = medianMillis(repeats, [&] { referenceEdges(rgb, expected); });
+        double fusedTime = medianMillis(repeats, [&] { EdgeKernel::detect(rgb, fused, 50, 150); });
+
+        Allocations refAlloc = countAllocations(size, [&] {
+            Mat out;
+            referenceEdges(rgb, out);
+        });
+        Allocations fusedAlloc = countAllocations(size, [&] {
+            Mat out;
+            EdgeKernel::detect(rgb, out, 50, 150);
+        });
+
+        // 与 CVFunction::edgeDetection 相同的调用方式
+        Mat bgr, fromBgr, fromGray;
+        cvtColor(rgb, bgr, COLOR_RGB2BGR);
+        ImageFrame bgrFrame(bgr, ORDER_BGR), grayFrame(rgb);
+        EdgeKernel::detect(bgrFrame.mat(), fromBgr, 50, 150, 0, bgrFrame.grayCode());
+        EdgeKernel::detect(grayFrame.gray(), fromGray, 50, 150);
+
+        bool sameRgb = countNonZero(expected != fused) == 0;
+        bool sameBgr = countNonZero(expected != fromBgr) == 0;
+        bool sameGray = countNonZero(expected != fromGray) == 0;
+        ok &= sameRgb && sameBgr && sameGray;
+        std::cout << std::setw(12) << (std::to_string(size.width) + "x" + std::to_string(size.height))
+                  << std::fixed << std::setprecision(2) << std::setw(14) << refTime << std::setw(10) << fusedTime
+                  << std::setw(9) << refTime / fusedTime << "x"
+                  << std::setw(12) << refAlloc.buffers << std::setprecision(1) << std::setw(10) << refAlloc.bytesPerPixel
+                  << std::setw(12) << fusedAlloc.buffers << std::setw(10) << fusedAlloc.bytesPerPixel
+                  << std::setw(6) << (sameRgb ? "yes" : "NO") << std::setw(6) << (sameBgr ? "yes" : "NO")
+                  << std::setw(6) << (sameGray ? "yes" : "NO") << std::endl;
+    }
+    if (!ok) std::cerr << "Error: fused edge output differs from the reference" << std::endl;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,155 @@
+#include "benchmark.h"
+#include "detectorregistry.h"
+#include "facedetector.h"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QTextStream>
+#include <iomanip>
+#include <iostream>
+
+struct LabeledImage
+{
+    QString path;
+    Mat gray;
+    std::vector<Rect> faces;  // 标注的人脸框
+};
+
+// 标注文件每行：图片路径 x y w h [x y w h ...]，路径相对于标注文件所在目录，# 开头为注释
+static bool loadLabels(const QString &file, std::vector<LabeledImage> &images)
+{
+    QFile list(file);
+    if (!list.open(QIODevice::ReadOnly | QIODevice::Text))
+    {
+        std::cerr << "Error: Could not open labels " << file.toStdString() << std::endl;
+        return false;
+    }
+
+    QDir base = QFileInfo(file).absoluteDir();
+    QTextStream in(&list);
+    while (!in.atEnd())
+    {
+        QStringList fields = in.readLine().simplified().split(' ', Qt::SkipEmptyParts);
+        if (fields.isEmpty() || fields.first().startsWith('#')) continue;
+
+        LabeledImage image;
+        image.path = base.absoluteFilePath(fields.takeFirst());
+        for (int i = 0; i + 3 < fields.size(); i += 4)
+            image.faces.emplace_back(fields[i].toInt(), fields[i + 1].toInt(), fields[i + 2].toInt(), fields[i + 3].toInt());
+
+        Mat bgr = imread(image.path.toStdString());
+        if (bgr.empty())
+        {
+            std::cerr << "Warning: skipping " << image.path.toStdString() << std::endl;
+            continue;
+        }
+        cvtColor(bgr, image.gray, COLOR_BGR2GRAY);
+        images.push_back(image);
+    }
+    return !images.empty();
+}
+
+static double iou(const Rect &a, const Rect &b)
+{
+    double inter = (a & b).area();
+    return inter > 0 ? inter / (a.area() + b.area() - inter) : 0.0;
+}
+
+// 贪心匹配，IoU 不低于 0.5 记为命中
+static int countHits(const std::vector<Rect> &detected, const std::vector<Rect> &truth)
+{
+    std::vector<bool> used(truth.size(), false);
+    int hits = 0;
+    for (const Rect &d : detected)
+    {
+        int best = -1;
+        double bestIou = 0.5;
+        for (size_t t = 0; t < truth.size(); t++)
+        {
+            double v = used[t] ? 0.0 : iou(d, truth[t]);
+            if (v >= bestIou)
+            {
+                bestIou = v;
+                best = static_cast<int>(t);
+            }
+        }
+        if (best >= 0)
+        {
+            used[best] = true;
+            hits++;
+        }
+    }
+    return hits;
+}
+
+// 用法：face <标注文件> [--models 目录] [工作分辨率...]，工作分辨率 0 表示原始分辨率
+int benchFace(const QStringList &args)
+{
+    QStringList rest = args;
+    QString models = "release";
+    int modelsAt = rest.indexOf("--models");
+    if (modelsAt >= 0 && modelsAt + 1 < rest.size())
+    {
+        models = rest[modelsAt + 1];
+        rest.erase(rest.begin() + modelsAt, rest.begin() + modelsAt + 2);
+    }
+    if (rest.isEmpty())
+    {
+        std::cerr << "Usage: ObjectExtractBench face <labels.txt> [--models dir] [working sizes...]" << std::endl;
+        return 1;
+    }
+
+    std::vector<LabeledImage> images;
+    if (!loadLabels(rest.takeFirst(), images)) return 1;
+
+    std::vector<int> sizes = {0, 1280, 960, 640, 480};
+    if (!rest.isEmpty())
+    {
+        sizes.clear();
+        for (const QString &arg : rest) sizes.push_back(arg.toInt());
+    }
+
+    DetectorRegistry::instance().setModelDirectory(models.toStdString());
+    DetectorRegistry::Lease faceDetector = DetectorRegistry::instance().acquire(CASCADE_FRONTAL_FACE);
+    DetectorRegistry::Lease eyesDetector = DetectorRegistry::instance().acquire(CASCADE_EYE_GLASSES);
+    if (!faceDetector || !eyesDetector)
+    {
+        std::cerr << "Error: Could not load cascades from " << models.toStdString() << std::endl;
+        return 1;
+    }
+
+    int truthCount = 0;
+    for (const LabeledImage &image : images) truthCount += static_cast<int>(image.faces.size());
+    std::cout << "face: " << images.size() << " images, " << truthCount << " labeled faces" << std::endl;
+    std::cout << std::setw(8) << "size" << std::setw(12) << "faces(ms)" << std::setw(12) << "eyes(ms)"
+              << std::setw(11) << "precision" << std::setw(9) << "recall" << std::setw(8) << "f1" << std::endl;
+
+    for (int size : sizes)
+    {
+        FaceOptions options;
+        options.workingSize = size;
+
+        double faceMs = 0, eyeMs = 0;
+        int detectedCount = 0, hits = 0;
+        for (const LabeledImage &image : images)
+        {
+            std::vector<Rect> faces;
+            faceMs += medianMillis(3, [&] { faces = FaceDetector::detectFaces(*faceDetector, image.gray, options); });
+            eyeMs += medianMillis(3, [&] {
+                for (const Rect &face : faces) FaceDetector::detectEyes(*eyesDetector, image.gray, face, options);
+            });
+            detectedCount += static_cast<int>(faces.size());
+            hits += countHits(faces, image.faces);
+        }
+
+        double precision = detectedCount ? static_cast<double>(hits) / detectedCount : 0.0;
+        double recall = truthCount ? static_cast<double>(hits) / truthCount : 0.0;
+        double f1 = precision + recall > 0 ? 2 * precision * recall / (precision + recall) : 0.0;
+        std::cout << std::setw(8) << (size > 0 ? std::to_string(size) : std::string("full"))
+                  << std::fixed << std::setprecision(2)
+                  << std::setw(12) << faceMs / images.size() << std::setw(12) << eyeMs / images.size()
+                  << std::setprecision(3) << std::setw(11) << precision << std::setw(9) << recall
+                  << std::setw(8) << f1 << std::endl;
+    }
+    return 0;
+}
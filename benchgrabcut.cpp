@@ -0,0 +1,129 @@
+#include "benchmark.h"
+#include "grabcutsegmenter.h"
+#include "grabcutsession.h"
+#include <QDir>
+#include <QFileInfo>
+#include <iomanip>
+#include <iostream>
+
+// 逗号分隔的数值列表
+static std::vector<double> parseList(const QString &text)
+{
+    std::vector<double> values;
+    for (const QString &field : text.split(',', Qt::SkipEmptyParts)) values.push_back(field.toDouble());
+    return values;
+}
+
+static Mat foregroundOf(const Mat &mask)
+{
+    return (mask == GC_FGD) | (mask == GC_PR_FGD);
+}
+
+static double maskIou(const Mat &a, const Mat &b)
+{
+    double inter = countNonZero(a & b);
+    double uni = countNonZero(a | b);
+    return uni > 0 ? inter / uni : 1.0;
+}
+
+// 用法：grabcut [--scales 0.5,0.25] [--bands 4,8,16] <图片或目录...>
+// 以全分辨率 GrabCut 的结果为基准，报告由粗到细模式的平均耗时和前景 IoU
+int benchGrabCut(const QStringList &args)
+{
+    QStringList rest = args;
+    std::vector<double> scales = {0.5, 0.25}, bands = {4, 8, 16};
+    for (const QString &name : {QString("--scales"), QString("--bands")})
+    {
+        int at = rest.indexOf(name);
+        if (at < 0 || at + 1 >= rest.size()) continue;
+        (name == "--scales" ? scales : bands) = parseList(rest[at + 1]);
+        rest.erase(rest.begin() + at, rest.begin() + at + 2);
+    }
+
+    QStringList paths;
+    for (const QString &arg : rest)
+    {
+        QFileInfo info(arg);
+        if (!info.isDir())
+        {
+            paths << arg;
+            continue;
+        }
+        QDir dir(arg);
+        for (const QString &name : dir.entryList({"*.png", "*.jpg", "*.jpeg", "*.bmp", "*.tif", "*.tiff"}, QDir::Files, QDir::Name))
+            paths << dir.absoluteFilePath(name);
+    }
+    if (paths.isEmpty())
+    {
+        std::cerr << "Usage: ObjectExtractBench grabcut [--scales 0.5,0.25] [--bands 4,8,16] <images or dirs...>" << std::endl;
+        return 1;
+    }
+
+    // 全分辨率结果只计算一次
+    std::vector<Mat> images, references;
+    double fullMs = 0;
+    for (const QString &path : paths)
+    {
+        Mat bgr = imread(path.toStdString());
+        if (bgr.empty())
+        {
+            std::cerr << "Warning: skipping " << path.toStdString() << std::endl;
+            continue;
+        }
+        Mat rgb, mask;
+        cvtColor(bgr, rgb, COLOR_BGR2RGB);
+        fullMs += medianMillis(1, [&] { GrabCutSegmenter::segment(rgb, mask, GrabCutOptions()); });
+        images.push_back(rgb);
+        references.push_back(foregroundOf(mask));
+    }
+    if (images.empty()) return 1;
+
+    std::cout << "grabcut: " << images.size() << " images, full resolution " << std::fixed << std::setprecision(1)
+              << fullMs / images.size() << " ms/image" << std::endl;
+    std::cout << std::setw(8) << "scale" << std::setw(8) << "band" << std::setw(12) << "time(ms)"
+              << std::setw(10) << "speedup" << std::setw(10) << "mean IoU" << std::setw(10) << "min IoU" << std::endl;
+
+    for (double scale : scales)
+    {
+        for (double band : bands)
+        {
+            GrabCutOptions options;
+            options.scale = scale;
+            options.bandWidth = static_cast<int>(band);
+
+            double ms = 0, iouSum = 0, iouMin = 1.0;
+            for (size_t i = 0; i < images.size(); i++)
+            {
+                Mat mask;
+                ms += medianMillis(1, [&] { GrabCutSegmenter::segment(images[i], mask, options); });
+                double v = maskIou(foregroundOf(mask), references[i]);
+                iouSum += v;
+                iouMin = std::min(iouMin, v);
+            }
+            std::cout << std::setw(8) << std::setprecision(3) << scale << std::setw(8) << options.bandWidth
+                      << std::setprecision(1) << std::setw(12) << ms / images.size()
+                      << std::setw(9) << fullMs / ms << "x" << std::setprecision(4)
+                      << std::setw(10) << iouSum / images.size() << std::setw(10) << iouMin << std::endl;
+        }
+    }
+
+    // 会话：同一图像上追加一轮迭代，以及在提亮后的图像上热启动一轮，与重新完整分割对比
+    double continueMs = 0, warmMs = 0, freshMs = 0, warmIou = 0;
+    for (const Mat &image : images)
+    {
+        GrabCutSession session;
+        session.run(image);
+        continueMs += medianMillis(1, [&] { session.run(image); });
+
+        Mat edited, freshMask;
+        image.convertTo(edited, -1, 1.0, 12);
+        freshMs += medianMillis(1, [&] { GrabCutSegmenter::segment(edited, freshMask, GrabCutOptions()); });
+        warmMs += medianMillis(1, [&] { session.run(edited); });
+        warmIou += maskIou(foregroundOf(session.labels()), foregroundOf(freshMask));
+    }
+    std::cout << "session: +1 iteration " << std::setprecision(1) << continueMs / images.size()
+              << " ms, warm start on edited image " << warmMs / images.size() << " ms vs "
+              << freshMs / images.size() << " ms fresh, IoU " << std::setprecision(4) << warmIou / images.size()
+              << std::endl;
+    return 0;
+}
@@ -0,0 +1,84 @@
+#include "benchmark.h"
+#include "hammingmatcher.h"
+#include <iomanip>
+#include <iostream>
+
+// 生成 ORB 形式的描述符：train 的前一半是 query 翻转少量比特后的副本，其余随机
+static void makeDescriptors(int count, RNG &rng, Mat &query, Mat &train)
+{
+    query.create(count, 32, CV_8UC1);
+    train.create(count, 32, CV_8UC1);
+    rng.fill(query, RNG::UNIFORM, 0, 256);
+    rng.fill(train, RNG::UNIFORM, 0, 256);
+
+    for (int i = 0; i < count / 2; i++)
+    {
+        int src = rng.uniform(0, count);
+        query.row(src).copyTo(train.row(i));
+        for (int k = rng.uniform(0, 24); k > 0; k--)
+            train.at<uchar>(i, rng.uniform(0, 32)) ^= static_cast<uchar>(1 << rng.uniform(0, 8));
+    }
+}
+
+static bool sameMatches(const std::vector<DMatch> &a, const std::vector<DMatch> &b)
+{
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); i++)
+    {
+        if (a[i].queryIdx != b[i].queryIdx || a[i].trainIdx != b[i].trainIdx || a[i].distance != b[i].distance)
+            return false;
+    }
+    return true;
+}
+
+int benchHamming(const QStringList &args)
+{
+    std::vector<int> counts = {250, 500, 1000, 2000, 5000, 10000};
+    if (!args.isEmpty())
+    {
+        counts.clear();
+        for (const QString &arg : args) counts.push_back(arg.toInt());
+    }
+
+    HammingMatcher::Isa best = HammingMatcher::detectIsa();
+    std::cout << "hamming: best kernel " << HammingMatcher::isaName(best) << std::endl;
+    std::cout << std::setw(8) << "count" << std::setw(12) << "bf(ms)";
+    for (int isa = HammingMatcher::ISA_SCALAR; isa <= best; isa++)
+        std::cout << std::setw(12) << (std::string(HammingMatcher::isaName(static_cast<HammingMatcher::Isa>(isa))) + "(ms)");
+    std::cout << std::setw(10) << "speedup" << std::endl;
+
+    RNG rng(0x5eed);
+    bool ok = true;
+    for (int count : counts)
+    {
+        if (count <= 0) continue;
+        Mat query, train;
+        makeDescriptors(count, rng, query, train);
+        int repeats = count <= 1000 ? 20 : 5;
+
+        BFMatcher bf(NORM_HAMMING, true);
+        std::vector<DMatch> expected;
+        double bfTime = medianMillis(repeats, [&] { bf.match(query, train, expected); });
+        std::cout << std::setw(8) << count << std::setw(12) << std::fixed << std::setprecision(3) << bfTime;
+
+        double bestTime = bfTime;
+        for (int isa = HammingMatcher::ISA_SCALAR; isa <= best; isa++)
+        {
+            HammingMatcher matcher;
+            matcher.setIsa(static_cast<HammingMatcher::Isa>(isa));
+            std::vector<DMatch> matches;
+            double t = medianMillis(repeats, [&] { matcher.match(query, train, matches); });
+            bestTime = std::min(bestTime, t);
+            std::cout << std::setw(12) << t;
+
+            if (!sameMatches(expected, matches))
+            {
+                std::cerr << std::endl << "Error: " << HammingMatcher::isaName(matcher.isa())
+                          << " result differs from BFMatcher at count " << count << std::endl;
+                ok = false;
+            }
+        }
+        std::cout << std::setw(9) << std::setprecision(2) << bfTime / bestTime << "x" << std::endl;
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,29 @@
+#include "benchmark.h"
+
+#include <QCoreApplication>
+#include <iostream>
+
+// 用法：ObjectExtractBench <基准名> [参数...]
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QStringList args = app.arguments().mid(1);
+    if (args.isEmpty())
+    {
+        std::cerr << "Usage: ObjectExtractBench hamming [count...] | pool [rounds] | face <labels.txt> [--models dir] [size...] | edge [repeats] | template [repeats] | contour [repeats] | grabcut [--scales s,...] [--bands px,...] <images...> | suite [--sizes vga,...] [--ops op,...] [--json file] [--baseline file]" << std::endl;
+        return 1;
+    }
+
+    QString name = args.takeFirst();
+    if (name == "hamming") return benchHamming(args);
+    if (name == "pool")    return benchPool(args);
+    if (name == "face")    return benchFace(args);
+    if (name == "edge")    return benchEdge(args);
+    if (name == "template") return benchTemplate(args);
+    if (name == "contour") return benchContour(args);
+    if (name == "grabcut") return benchGrabCut(args);
+    if (name == "suite")   return benchSuite(args);
+
+    std::cerr << "Error: unknown benchmark " << name.toStdString() << std::endl;
+    return 1;
+}
@@ -0,0 +1,101 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include "opencv2/opencv.hpp"
+#include <QStringList>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <numeric>
+
+using namespace cv;
+
+struct LatencyStats
+{
+    int samples = 0;
+    double median = 0;
+    double p99 = 0;
+    double mean = 0;
+    double min = 0;
+};
+
+// 重复执行 body，返回耗时（毫秒）的分布
+inline LatencyStats measureLatency(int repeats, const std::function<void()> &body)
+{
+    std::vector<double> times;
+    for (int i = 0; i < repeats; i++)
+    {
+        auto start = std::chrono::steady_clock::now();
+        body();
+        times.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    }
+    std::sort(times.begin(), times.end());
+    LatencyStats stats;
+    stats.samples = static_cast<int>(times.size());
+    stats.median = times[times.size() / 2];
+    stats.p99 = times[std::min(times.size() - 1, static_cast<size_t>(std::ceil(times.size() * 0.99)) - 1)];
+    stats.mean = std::accumulate(times.begin(), times.end(), 0.0) / times.size();
+    stats.min = times.front();
+    return stats;
+}
+
+// 重复执行 body，返回每次耗时（毫秒）的中位数
+inline double medianMillis(int repeats, const std::function<void()> &body)
+{
+    return measureLatency(repeats, body).median;
+}
+
+// 统计经由 cv::Mat 的全部分配，包括被测函数内部的临时结果；实际分配仍交给 OpenCV 的标准分配器，
+// 释放时 UMatData 直接回到标准分配器。用 Mat::setDefaultAllocator 安装，测量结束后恢复原来的分配器。
+// frame 非空时另外统计与其同尺寸的二维分配（frameType 为 -1 时不限类型），即整幅图像的缓冲
+class CountingAllocator : public MatAllocator
+{
+public:
+    explicit CountingAllocator(Size frame = Size(), int frameType = -1) : frame(frame), frameType(frameType) {}
+
+    UMatData *allocate(int dims, const int *sizes, int type, void *data, size_t *step, AccessFlag flags,
+                       UMatUsageFlags usageFlags) const override
+    {
+        UMatData *u = Mat::getStdAllocator()->allocate(dims, sizes, type, data, step, flags, usageFlags);
+        if (u && !data)
+        {
+            count++;
+            bytes += u->size;
+            if (dims == 2 && sizes[0] == frame.height && sizes[1] == frame.width && (frameType < 0 || type == frameType))
+                frames++;
+        }
+        return u;
+    }
+
+    bool allocate(UMatData *data, AccessFlag accessFlags, UMatUsageFlags usageFlags) const override
+    {
+        return Mat::getStdAllocator()->allocate(data, accessFlags, usageFlags);
+    }
+
+    void deallocate(UMatData *data) const override
+    {
+        Mat::getStdAllocator()->deallocate(data);
+    }
+
+    void reset() { count = 0; bytes = 0; frames = 0; }
+
+    mutable std::atomic<int> count{0};
+    mutable std::atomic<size_t> bytes{0};
+    mutable std::atomic<int> frames{0};
+
+private:
+    Size frame;
+    int frameType;
+};
+
+// 各基准的入口，参数为命令行中基准名之后的部分，返回进程退出码
+int benchHamming(const QStringList &args);
+int benchPool(const QStringList &args);
+int benchFace(const QStringList &args);
+int benchEdge(const QStringList &args);
+int benchTemplate(const QStringList &args);
+int benchContour(const QStringList &args);
+int benchGrabCut(const QStringList &args);
+int benchSuite(const QStringList &args);
+
+#endif // BENCHMARK_H
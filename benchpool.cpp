@@ -0,0 +1,67 @@
+#include "benchmark.h"
+#include "cvfunction.h"
+#include "imagepool.h"
+#include <iostream>
+
+// 模拟界面中的连续操作：第一轮之后每次操作都应复用池中的缓冲，不再分配池缓冲，也不再产生整帧副本；
+// 每次操作经由 Mat 的分配次数和字节数一并输出
+int benchPool(const QStringList &args)
+{
+    int rounds = args.isEmpty() ? 5 : std::max(2, args.first().toInt());
+
+    ImagePool pool;
+    RNG rng(0x900d);
+    Mat src(720, 1280, CV_8UC3);
+    rng.fill(src, RNG::UNIFORM, 0, 256);
+    pool.src = ImageFrame(src);
+    pool.ref = ImageFrame(src(Rect(400, 300, 96, 64)).clone());
+    pool.refTemplate = std::make_shared<PreparedTemplate>(pool.ref);
+
+    struct Operation
+    {
+        const char *name;
+        std::function<Mat(ImagePool &)> run;
+    };
+    std::vector<Operation> operations = {
+        {"template", [](ImagePool &p) { return CVFunction::templateSearch(p.src, *p.refTemplate, p.dst, Method::TM_CCOEFF); }},
+        {"edge",     [](ImagePool &p) { return CVFunction::edgeDetection(p.src, p.dst, 3); }},
+    };
+
+    CountingAllocator counter(src.size(), src.type());
+    MatAllocator *previous = Mat::getDefaultAllocator();
+    Mat::setDefaultAllocator(&counter);
+
+    bool ok = true;
+    for (int round = 0; round < rounds; round++)
+    {
+        for (const Operation &op : operations)
+        {
+            ImagePool::Stats before = pool.stats();
+            counter.reset();
+            double ms = medianMillis(1, [&] {
+                pool.beginOperation();
+                pool.cut = op.run(pool);
+            });
+
+            int allocations = pool.stats().allocations - before.allocations;
+            int frameCopies = counter.frames;  // 与源图同尺寸同类型，即整帧彩色副本
+            std::cout << "round " << round << "  " << op.name << "  pool allocations " << allocations
+                      << "  mat allocations " << counter.count << " (" << counter.bytes / 1024 << " KB)"
+                      << "  frame copies " << frameCopies << "  " << ms << " ms" << std::endl;
+            if (round > 0 && allocations != 0)
+            {
+                std::cerr << "Error: " << op.name << " allocated " << allocations << " buffers after warm-up" << std::endl;
+                ok = false;
+            }
+            if (round > 0 && frameCopies != 0)
+            {
+                std::cerr << "Error: " << op.name << " made " << frameCopies << " full-frame copies after warm-up" << std::endl;
+                ok = false;
+            }
+        }
+    }
+    Mat::setDefaultAllocator(previous);
+    std::cout << "pool: " << pool.stats().allocations << " allocations, " << pool.stats().leases << " leases, "
+              << pool.idleCount() << " idle" << std::endl;
+    return ok ? 0 : 1;
+}
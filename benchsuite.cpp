@@ -0,0 +1,403 @@
+#include "benchmark.h"
+#include "cvfunction.h"
+#include "templatematcher.h"
+#include "preparedtemplate.h"
+#include "fftmatcher.h"
+#include "objecttracker.h"
+#include "facedetector.h"
+#include "grabcutsegmenter.h"
+#include "detectorregistry.h"
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSysInfo>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <fstream>
+#include <sys/resource.h>
+#endif
+
+// 进程的内存峰值（字节）。只有 Linux 能通过 /proc/self/clear_refs 重置峰值，使每个操作单独统计；
+// Windows 的 PeakWorkingSetSize 和 macOS 的 ru_maxrss 是进程启动以来的累计最大值，无法归到单个操作，
+// 重置失败时返回 false，该操作的峰值不报告
+static bool resetPeakMemory()
+{
+#ifdef __linux__
+    std::ofstream clear("/proc/self/clear_refs");
+    clear << "5";
+    clear.flush();
+    return static_cast<bool>(clear);
+#else
+    return false;
+#endif
+}
+
+static size_t peakMemory()
+{
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) return counters.PeakWorkingSetSize;
+    return 0;
+#else
+#ifdef __linux__
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line))
+    {
+        if (line.rfind("VmHWM:", 0) == 0) return std::stoull(line.substr(6)) * 1024;
+    }
+#endif
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    return usage.ru_maxrss;
+#else
+    return static_cast<size_t>(usage.ru_maxrss) * 1024;
+#endif
+#endif
+}
+
+struct Resolution
+{
+    const char *name;
+    Size size;
+};
+
+static const Resolution RESOLUTIONS[] = {
+    {"vga", Size(640, 480)},   {"hd", Size(1280, 720)},   {"fhd", Size(1920, 1080)},
+    {"4k", Size(3840, 2160)},  {"8k", Size(7680, 4320)},
+};
+
+// 确定性的测试图（RGB）：渐变背景、随机图形、纹理块和噪声，种子只由尺寸决定
+static Mat makeScene(Size size)
+{
+    RNG rng(0x5eed ^ (static_cast<uint64>(size.width) << 16) ^ size.height);
+    Mat img(size, CV_8UC3);
+    for (int y = 0; y < size.height; y++)
+    {
+        Vec3b *row = img.ptr<Vec3b>(y);
+        for (int x = 0; x < size.width; x++)
+            row[x] = Vec3b(static_cast<uchar>(x * 255 / size.width), static_cast<uchar>(y * 255 / size.height), 96);
+    }
+    int shapes = 40 + size.area() / 200000;
+    for (int i = 0; i < shapes; i++)
+    {
+        Scalar color(rng.uniform(0, 256), rng.uniform(0, 256), rng.uniform(0, 256));
+        Point center(rng.uniform(0, size.width), rng.uniform(0, size.height));
+        circle(img, center, rng.uniform(4, std::max(5, size.width / 12)), color, FILLED);
+        rectangle(img, Rect(rng.uniform(0, size.width), rng.uniform(0, size.height), rng.uniform(8, size.width / 6),
+                            rng.uniform(8, size.height / 6)), color, rng.uniform(1, 6));
+    }
+
+    // 中央放一块高纹理区域作为模板和追踪目标，保证有足够的角点
+    Rect target(size.width * 2 / 5, size.height * 2 / 5, size.width / 5, size.height / 5);
+    Mat texture(target.size(), CV_8UC3);
+    rng.fill(texture, RNG::UNIFORM, 0, 256);
+    GaussianBlur(texture, texture, Size(5, 5), 0);
+    texture.copyTo(img(target));
+
+    Mat noise(size, CV_16SC3);
+    rng.fill(noise, RNG::NORMAL, 0, 6);
+    add(img, noise, img, noArray(), CV_8U);
+    return img;
+}
+
+// 指定目录时用其中第一张图片缩放到各分辨率，否则生成
+static Mat loadScene(const QString &imageDir, Size size)
+{
+    if (imageDir.isEmpty()) return makeScene(size);
+    QDir dir(imageDir);
+    for (const QString &name : dir.entryList({"*.png", "*.jpg", "*.jpeg", "*.bmp"}, QDir::Files, QDir::Name))
+    {
+        Mat bgr = imread(dir.absoluteFilePath(name).toStdString());
+        if (bgr.empty()) continue;
+        Mat rgb, scaled;
+        cvtColor(bgr, rgb, COLOR_BGR2RGB);
+        resize(rgb, scaled, size, 0, 0, bgr.cols > size.width ? INTER_AREA : INTER_LINEAR);
+        return scaled;
+    }
+    std::cerr << "Warning: no images in " << imageDir.toStdString() << ", using generated scenes" << std::endl;
+    return makeScene(size);
+}
+
+struct Measurement
+{
+    QString op;
+    QString size;
+    Size resolution;
+    int templateSide = 0;
+    LatencyStats latency;
+    bool hasPeak = false;  // 峰值能否重置；否则 peakBytes 是累计值，不报告
+    size_t peakBytes = 0;
+
+    QString key() const { return op + "/" + size + (templateSide ? QString("/t%1").arg(templateSide) : QString()); }
+};
+
+struct SuiteOptions
+{
+    QStringList sizes = {"vga", "hd", "fhd", "4k", "8k"};
+    QStringList ops;              // 为空时运行全部，否则按前缀筛选
+    std::vector<int> templates = {32, 128};
+    int warmup = 2;
+    int repeats = 10;
+    int grabcutMaxPixels = 1280 * 720;  // 全分辨率 GrabCut 只在不超过该像素数的分辨率上运行
+    QString imageDir;
+    QString models = "release";
+    QString jsonPath = "bench-results.json";
+    QString baselinePath;
+    double tolerance = 0.10;      // 中位数比基线慢超过该比例视为退化
+};
+
+static bool parseSuiteArgs(const QStringList &args, SuiteOptions &options)
+{
+    for (int i = 0; i < args.size(); i++)
+    {
+        const QString &arg = args[i];
+        if (i + 1 >= args.size())
+        {
+            std::cerr << "Error: missing value for " << arg.toStdString() << std::endl;
+            return false;
+        }
+        QString value = args[++i];
+        if (arg == "--sizes") options.sizes = value.toLower().split(',', Qt::SkipEmptyParts);
+        else if (arg == "--ops") options.ops = value.split(',', Qt::SkipEmptyParts);
+        else if (arg == "--templates")
+        {
+            options.templates.clear();
+            for (const QString &t : value.split(',', Qt::SkipEmptyParts)) options.templates.push_back(t.toInt());
+        }
+        else if (arg == "--warmup") options.warmup = std::max(0, value.toInt());
+        else if (arg == "--repeats") options.repeats = std::max(1, value.toInt());
+        else if (arg == "--grabcut-max") options.grabcutMaxPixels = value.toInt();
+        else if (arg == "--images") options.imageDir = value;
+        else if (arg == "--models") options.models = value;
+        else if (arg == "--json") options.jsonPath = value;
+        else if (arg == "--baseline") options.baselinePath = value;
+        else if (arg == "--tolerance") options.tolerance = value.toDouble();
+        else
+        {
+            std::cerr << "Error: unknown option " << arg.toStdString() << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool selected(const SuiteOptions &options, const QString &op)
+{
+    if (options.ops.isEmpty()) return true;
+    for (const QString &prefix : options.ops)
+        if (op.startsWith(prefix)) return true;
+    return false;
+}
+
+static QJsonObject toJson(const Measurement &m)
+{
+    QJsonObject o;
+    o["key"] = m.key();
+    o["op"] = m.op;
+    o["size"] = m.size;
+    o["width"] = m.resolution.width;
+    o["height"] = m.resolution.height;
+    if (m.templateSide) o["template"] = m.templateSide;
+    o["samples"] = m.latency.samples;
+    o["median_ms"] = m.latency.median;
+    o["p99_ms"] = m.latency.p99;
+    o["mean_ms"] = m.latency.mean;
+    o["min_ms"] = m.latency.min;
+    o["throughput_per_s"] = m.latency.median > 0 ? 1000.0 / m.latency.median : 0.0;
+    o["megapixels_per_s"] = m.latency.median > 0 ? m.resolution.area() / 1e6 * 1000.0 / m.latency.median : 0.0;
+    o["peak_rss_mb"] = m.hasPeak ? QJsonValue(m.peakBytes / (1024.0 * 1024.0)) : QJsonValue(QJsonValue::Null);
+    return o;
+}
+
+// 与基线比较中位数，返回退化的项数
+static int compareBaseline(const QString &path, const std::vector<Measurement> &results, double tolerance)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        std::cerr << "Error: Could not open baseline " << path.toStdString() << std::endl;
+        return -1;
+    }
+    QJsonArray entries = QJsonDocument::fromJson(file.readAll()).object()["results"].toArray();
+    std::map<QString, double> baseline;
+    for (const QJsonValue &entry : entries)
+        baseline[entry.toObject()["key"].toString()] = entry.toObject()["median_ms"].toDouble();
+
+    std::cout << std::endl << "baseline " << path.toStdString() << " (tolerance " << tolerance * 100 << "%)" << std::endl;
+    std::cout << std::left << std::setw(34) << "key" << std::right << std::setw(12) << "base(ms)"
+              << std::setw(12) << "now(ms)" << std::setw(10) << "change" << std::endl;
+    int regressions = 0;
+    for (const Measurement &m : results)
+    {
+        auto it = baseline.find(m.key());
+        if (it == baseline.end() || it->second <= 0) continue;
+        double change = m.latency.median / it->second - 1.0;
+        bool regressed = change > tolerance;
+        regressions += regressed;
+        std::cout << std::left << std::setw(34) << m.key().toStdString() << std::right << std::fixed
+                  << std::setprecision(2) << std::setw(12) << it->second << std::setw(12) << m.latency.median
+                  << std::setw(9) << std::showpos << change * 100 << std::noshowpos << "%"
+                  << (regressed ? "  REGRESSION" : "") << std::endl;
+    }
+    return regressions;
+}
+
+// 用法：suite [--sizes vga,hd,fhd,4k,8k] [--ops 前缀,...] [--templates 32,128] [--warmup n] [--repeats n]
+//             [--grabcut-max 像素数] [--images 目录] [--models 目录] [--json 输出] [--baseline 基线] [--tolerance 0.1]
+int benchSuite(const QStringList &args)
+{
+    SuiteOptions options;
+    if (!parseSuiteArgs(args, options)) return 1;
+
+    DetectorRegistry::instance().setModelDirectory(options.models.toStdString());
+    bool haveCascades = false;
+    {
+        DetectorRegistry::Lease face = DetectorRegistry::instance().acquire(CASCADE_FRONTAL_FACE);
+        DetectorRegistry::Lease eyes = DetectorRegistry::instance().acquire(CASCADE_EYE_GLASSES);
+        haveCascades = face && eyes;
+    }
+    if (!haveCascades && selected(options, "face"))
+        std::cerr << "Warning: cascades not found in " << options.models.toStdString() << ", skipping face" << std::endl;
+
+    if (!resetPeakMemory())
+        std::cerr << "Warning: per-operation peak memory is not supported on this platform, peak_rss_mb will be null" << std::endl;
+
+    std::vector<Measurement> results;
+    std::cout << std::left << std::setw(34) << "key" << std::right << std::setw(11) << "median(ms)"
+              << std::setw(10) << "p99(ms)" << std::setw(10) << "ops/s" << std::setw(10) << "MP/s"
+              << std::setw(10) << "peak MB" << std::endl;
+
+    // 每个操作先预热再重复计时；grabcut 单次耗时长，重复次数上限为 3
+    auto run = [&](const QString &op, const Resolution &res, int templateSide, int repeats,
+                   const std::function<void()> &body) {
+        if (!selected(options, op)) return;
+        Measurement m;
+        m.op = op;
+        m.size = res.name;
+        m.resolution = res.size;
+        m.templateSide = templateSide;
+        for (int i = 0; i < options.warmup; i++) body();
+        m.hasPeak = resetPeakMemory();
+        m.latency = measureLatency(repeats, body);
+        m.peakBytes = peakMemory();
+        results.push_back(m);
+
+        std::cout << std::left << std::setw(34) << m.key().toStdString() << std::right << std::fixed
+                  << std::setprecision(2) << std::setw(11) << m.latency.median << std::setw(10) << m.latency.p99
+                  << std::setw(10) << 1000.0 / m.latency.median
+                  << std::setw(10) << res.size.area() / 1e6 * 1000.0 / m.latency.median << std::setprecision(1);
+        if (m.hasPeak)
+            std::cout << std::setw(10) << m.peakBytes / (1024.0 * 1024.0) << std::endl;
+        else
+            std::cout << std::setw(10) << "n/a" << std::endl;
+    };
+
+    for (const Resolution &res : RESOLUTIONS)
+    {
+        if (!options.sizes.contains(res.name)) continue;
+        Mat src = loadScene(options.imageDir, res.size);
+        Mat dst = src.clone();
+        Point center(src.cols / 2, src.rows / 2);
+
+        for (int side : options.templates)
+        {
+            if (side >= std::min(src.cols, src.rows)) continue;
+            Mat ref = src(Rect(center.x - side / 2, center.y - side / 2, side, side)).clone();
+            PreparedTemplate prepared(ref);
+            FftMatcher fft(prepared, src.size());
+            run("template", res, side, options.repeats,
+                [&] { CVFunction::templateSearch(src, ref, dst, Method::TM_CCOEFF_NORMED); });
+            run("template-prepared", res, side, options.repeats,
+                [&] { CVFunction::templateSearch(src, prepared, dst, Method::TM_CCOEFF_NORMED); });
+            run("template-fft", res, side, options.repeats,
+                [&] { CVFunction::templateSearch(src, fft, dst, Method::TM_CCOEFF_NORMED); });
+            run("template-pyramid", res, side, options.repeats,
+                [&] { CVFunction::templateSearch(src, ref, dst, Method::TM_CCOEFF_NORMED, PyramidOptions()); });
+            run("template-tiled", res, side, options.repeats,
+                [&] { CVFunction::templateSearch(src, ref, dst, Method::TM_CCOEFF_NORMED, TiledOptions()); });
+        }
+
+        // 追踪的单帧开销：完整 ORB 检测 + 匹配 + 单应性，以及增量模式下的光流跟踪
+        {
+            Rect target(src.cols * 2 / 5, src.rows * 2 / 5, src.cols / 5, src.rows / 5);
+            ObjectTracker tracker(src(target).clone());
+            Mat gray, shifted;
+            cvtColor(src, gray, COLOR_RGB2GRAY);
+            Mat shift = (Mat_<double>(2, 3) << 1, 0, 2, 0, 1, 1);
+            warpAffine(gray, shifted, shift, gray.size());
+            run("track-detect", res, 0, options.repeats, [&] {
+                TrackFeatures features;
+                tracker.extract(gray, features);
+                tracker.locate(features);
+            });
+
+            TrackFeatures features;
+            tracker.extract(gray, features);
+            tracker.track(gray, features);
+            int frame = 0;
+            run("track-flow", res, 0, options.repeats, [&] {
+                const Mat &current = frame++ % 2 ? gray : shifted;
+                TrackFeatures next;
+                if (tracker.needsDetection()) tracker.extract(current, next);
+                tracker.track(current, next);
+            });
+        }
+
+        if (haveCascades)
+        {
+            run("face", res, 0, options.repeats, [&] { CVFunction::faceSearch(src, dst); });
+            FaceOptions fast;
+            fast.workingSize = 640;
+            run("face-640", res, 0, options.repeats, [&] { CVFunction::faceSearch(src, dst, fast); });
+        }
+
+        run("edge", res, 0, options.repeats, [&] { CVFunction::edgeDetection(src, dst, 3); });
+
+        if (res.size.area() <= options.grabcutMaxPixels)
+            run("grabcut", res, 0, std::min(options.repeats, 3),
+                [&] { CVFunction::grabcutForegroundExtraction(src, dst); });
+        GrabCutOptions coarse;
+        coarse.scale = std::min(1.0, 800.0 / std::max(src.cols, src.rows));
+        run("grabcut-fast", res, 0, std::min(options.repeats, 3),
+            [&] { CVFunction::grabcutForegroundExtraction(src, dst, coarse); });
+    }
+
+    QJsonArray entries;
+    for (const Measurement &m : results) entries.append(toJson(m));
+    QJsonObject root;
+    root["version"] = 1;
+    root["date"] = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+    root["host"] = QSysInfo::machineHostName();
+    root["cpu"] = QSysInfo::currentCpuArchitecture();
+    root["opencv"] = CV_VERSION;
+    root["threads"] = getNumThreads();
+    root["warmup"] = options.warmup;
+    root["repeats"] = options.repeats;
+    root["results"] = entries;
+
+    QFile out(options.jsonPath);
+    if (!out.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        std::cerr << "Error: Could not write " << options.jsonPath.toStdString() << std::endl;
+        return 1;
+    }
+    out.write(QJsonDocument(root).toJson());
+    std::cout << "results written to " << options.jsonPath.toStdString() << std::endl;
+
+    if (options.baselinePath.isEmpty()) return 0;
+    int regressions = compareBaseline(options.baselinePath, results, options.tolerance);
+    if (regressions < 0) return 1;
+    if (regressions > 0) std::cerr << "Error: " << regressions << " regressions against the baseline" << std::endl;
+    return regressions == 0 ? 0 : 1;
+}
@@ -0,0 +1,96 @@
+#include "benchmark.h"
+#include "templatematcher.h"
+#include <iomanip>
+#include <iostream>
+
+// 确定性的测试图（灰度）：渐变背景上叠加随机图形和噪声
+static Mat makeScene(Size size, RNG &rng)
+{
+    Mat img(size, CV_8UC1);
+    for (int y = 0; y < size.height; y++)
+    {
+        uchar *row = img.ptr(y);
+        for (int x = 0; x < size.width; x++) row[x] = static_cast<uchar>((x + y) * 255 / (size.width + size.height));
+    }
+    for (int i = 0; i < 80; i++)
+    {
+        Scalar color(rng.uniform(0, 256));
+        Point center(rng.uniform(0, size.width), rng.uniform(0, size.height));
+        circle(img, center, rng.uniform(4, size.width / 10), color, FILLED);
+        rectangle(img, Rect(rng.uniform(0, size.width), rng.uniform(0, size.height), rng.uniform(8, size.width / 6),
+                            rng.uniform(8, size.height / 6)), color, rng.uniform(1, 6));
+    }
+    Mat noise(size, CV_16SC1);
+    rng.fill(noise, RNG::NORMAL, 0, 8);
+    Mat out;
+    add(img, noise, out, noArray(), CV_8U);
+    return out;
+}
+
+static const char *methodName(Method METHOD)
+{
+    static const char *names[] = {"SQDIFF", "SQDIFF_NORMED", "CCORR", "CCORR_NORMED", "CCOEFF", "CCOEFF_NORMED"};
+    return names[METHOD];
+}
+
+// 分条带匹配与整图 matchTemplate 的对比：各条带按自身尺寸选择 DFT 分块，得分只要求在浮点舍入范围内一致。
+// 偏差按整图得分的取值范围归一化，超过 TOLERANCE 或最佳位置的整图得分与最优值之差超过容差时判为失败
+int benchTemplate(const QStringList &args)
+{
+    const double TOLERANCE = 1e-4;
+    std::vector<Size> sizes = {Size(640, 480), Size(1920, 1080), Size(3840, 2160)};
+    std::vector<int> templates = {32, 96};
+    int repeats = args.isEmpty() ? 5 : std::max(1, args.first().toInt());
+
+    std::cout << std::setw(12) << "size" << std::setw(7) << "templ" << std::setw(15) << "method"
+              << std::setw(11) << "full(ms)" << std::setw(11) << "tiled(ms)" << std::setw(12) << "max dev"
+              << std::setw(10) << "bitwise" << std::setw(10) << "same loc" << std::endl;
+
+    RNG rng(0x7e3a);
+    bool ok = true;
+    int bitwise = 0, runs = 0;
+    for (Size size : sizes)
+    {
+        Mat src = makeScene(size, rng);
+        for (int side : templates)
+        {
+            Rect target(size.width / 3, size.height / 2, side, side);
+            Mat ref = src(target).clone();
+            for (int m = Method::TM_SQDIFF; m <= Method::TM_CCOEFF_NORMED; m++)
+            {
+                Method METHOD = static_cast<Method>(m);
+                Mat full, tiled;
+                double fullTime = medianMillis(repeats, [&] { matchTemplate(src, ref, full, METHOD); });
+                double tiledTime = medianMillis(repeats, [&] {
+                    TemplateMatcher::tiledMatch(src, ref, tiled, METHOD, TiledOptions());
+                });
+
+                double lo, hi, dev;
+                Point minLoc, maxLoc, tMinLoc, tMaxLoc;
+                minMaxLoc(full, &lo, &hi, &minLoc, &maxLoc);
+                dev = norm(full, tiled, NORM_INF) / std::max(hi - lo, 1e-12);
+                minMaxLoc(tiled, nullptr, nullptr, &tMinLoc, &tMaxLoc);
+
+                bool minBest = TemplateMatcher::isMinBest(METHOD);
+                Point best = minBest ? minLoc : maxLoc, tiledBest = minBest ? tMinLoc : tMaxLoc;
+                // 位置不同时只接受并列最优：分块结果选中的位置在整图得分上与最优值相差不超过容差
+                double gap = std::abs(full.at<float>(tiledBest) - full.at<float>(best)) / std::max(hi - lo, 1e-12);
+                bool sameLoc = best == tiledBest;
+                bool same = countNonZero(full != tiled) == 0;
+                bitwise += same;
+                runs++;
+                ok &= dev <= TOLERANCE && (sameLoc || gap <= TOLERANCE);
+
+                std::cout << std::setw(12) << (std::to_string(size.width) + "x" + std::to_string(size.height))
+                          << std::setw(7) << side << std::setw(15) << methodName(METHOD)
+                          << std::fixed << std::setprecision(2) << std::setw(11) << fullTime << std::setw(11) << tiledTime
+                          << std::scientific << std::setprecision(1) << std::setw(12) << dev << std::fixed
+                          << std::setw(10) << (same ? "yes" : "no") << std::setw(10) << (sameLoc ? "yes" : gap <= TOLERANCE ? "tie" : "NO")
+                          << std::endl;
+            }
+        }
+    }
+    std::cout << "bitwise identical: " << bitwise << "/" << runs << std::endl;
+    if (!ok) std::cerr << "Error: tiled scores deviate from full-image matchTemplate beyond " << TOLERANCE << std::endl;
+    return ok ? 0 : 1;
+}
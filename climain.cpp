@@ -0,0 +1,220 @@
+#include "batchpipeline.h"
+#include "detectorregistry.h"
+#include "streamrunner.h"
+#include "traceprobe.h"
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDirIterator>
+#include <QFile>
+#include <QTextStream>
+
+static const QStringList imageFilters = {"*.png", "*.jpg", "*.jpeg", "*.bmp", "*.tif", "*.tiff", "*.ppm", "*.pgm", "*.pnm"};
+
+// 指定了 --trace 时把记录的阶段耗时写成 Chrome trace JSON
+static void writeTrace(const QString &path)
+{
+    if (path.isEmpty()) return;
+    if (!TraceProbe::exportChrome(path.toStdString()))
+        std::cerr << "Error: Could not write trace " << path.toStdString() << std::endl;
+}
+
+static bool parseOperation(const QString &name, BatchOperation &op)
+{
+    if      (name == "template") op = BATCH_TEMPLATE;
+    else if (name == "face")     op = BATCH_FACE;
+    else if (name == "edge")     op = BATCH_EDGE;
+    else if (name == "grabcut")  op = BATCH_GRABCUT;
+    else return false;
+    return true;
+}
+
+static bool parseMethod(const QString &name, Method &method)
+{
+    static const char *names[] = {"sqdiff", "sqdiff_normed", "ccorr", "ccorr_normed", "ccoeff", "ccoeff_normed"};
+    for (int i = 0; i < 6; i++)
+    {
+        if (name == names[i])
+        {
+            method = static_cast<Method>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+// 目录按扩展名展开，文件直接加入
+static void collectInputs(const QString &path, bool recursive, QStringList &inputs)
+{
+    QFileInfo info(path);
+    if (info.isDir())
+    {
+        QStringList found;
+        QDirIterator it(path, imageFilters, QDir::Files,
+                        recursive ? QDirIterator::Subdirectories : QDirIterator::NoIteratorFlags);
+        while (it.hasNext()) found << it.next();
+        found.sort();
+        inputs << found;
+    }
+    else if (info.isFile())
+    {
+        inputs << path;
+    }
+    else
+    {
+        std::cerr << "Warning: skipping " << path.toStdString() << std::endl;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("ObjectExtractCli");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Batch runner for the ObjectExtract operations.");
+    parser.addHelpOption();
+    parser.addPositionalArgument("inputs", "Image files or directories.", "[inputs...]");
+
+    QCommandLineOption opOption({"p", "op"}, "Operation: template, face, edge, grabcut or face-stream.", "op");
+    QCommandLineOption outOption({"o", "output"}, "Output directory.", "dir");
+    QCommandLineOption listOption({"l", "list"}, "Text file with one input path per line.", "file");
+    QCommandLineOption refOption({"r", "ref"}, "Reference image for template search.", "file");
+    QCommandLineOption methodOption({"m", "method"}, "Template method: sqdiff, ccorr, ccoeff (and *_normed).", "method", "sqdiff");
+    QCommandLineOption pyramidOption("pyramid", "Pyramid levels for template search (1 = full resolution only).", "n", "1");
+    QCommandLineOption candidatesOption("candidates", "Candidates kept per pyramid level.", "n", "4");
+    QCommandLineOption allMatchesOption("all-matches", "Return every template match scoring above this threshold (0..1).", "score");
+    QCommandLineOption tileThreadsOption("tile-threads", "Split each template search into strips on this many threads.", "n", "0");
+    QCommandLineOption tileRowsOption("tile-rows", "Score-map rows per strip (0 = automatic).", "n", "0");
+    QCommandLineOption faceSizeOption("face-size", "Detect faces on a copy whose long side is this many pixels (0 = full resolution).", "px", "0");
+    QCommandLineOption allFacesOption("all-faces", "Write every detected face with its eye boxes instead of the first face.");
+    QCommandLineOption cameraOption("camera", "Camera index for face-stream.", "index");
+    QCommandLineOption framesOption("frames", "Frames to process per stream (0 = until the end, 300 for cameras).", "n", "0");
+    QCommandLineOption scanIntervalOption("scan-interval", "Full-frame face scan every n frames in face-stream.", "n", "15");
+    QCommandLineOption grabcutScaleOption("grabcut-scale", "Run GrabCut on a copy scaled by this factor, then refine the boundary at full resolution (1 = full resolution only).", "factor", "1");
+    QCommandLineOption grabcutBandOption("grabcut-band", "Width in pixels of the boundary band refined at full resolution.", "px", "8");
+    QCommandLineOption tiledOption("tiled-above", "Memory-map PPM/PGM inputs of at least this many megapixels and run template/edge tile by tile (0 = never).", "mp", "100");
+    QCommandLineOption kernelOption("kernel", "Sobel kernel size for edge detection.", "size", "3");
+    QCommandLineOption jobsOption({"j", "jobs"}, "Processing threads (0 = all cores).", "n", "0");
+    QCommandLineOption queueOption("queue", "Capacity of each pipeline queue (0 = 2 x jobs).", "n", "0");
+    QCommandLineOption formatOption({"f", "format"}, "Output image format.", "ext", "png");
+    QCommandLineOption modelsOption("models", "Directory with the Haar cascade XML files.", "dir", "release");
+    QCommandLineOption recursiveOption("recursive", "Scan input directories recursively.");
+    QCommandLineOption cutOnlyOption("cut-only", "Only write the cropped result.");
+    QCommandLineOption traceOption("trace", "Record per-stage timings and write them as Chrome trace JSON.", "file");
+    parser.addOptions({opOption, outOption, listOption, refOption, methodOption, pyramidOption, candidatesOption,
+                       allMatchesOption, tileThreadsOption, tileRowsOption, faceSizeOption, allFacesOption, kernelOption,
+                       grabcutScaleOption, grabcutBandOption, tiledOption, cameraOption, framesOption, scanIntervalOption,
+                       jobsOption, queueOption, formatOption, modelsOption, recursiveOption, cutOnlyOption, traceOption});
+    parser.process(app);
+    QString tracePath = parser.value(traceOption);
+    TraceProbe::setEnabled(!tracePath.isEmpty());
+
+    // 视频流不经过批处理流水线，逐帧顺序处理
+    if (parser.value(opOption) == "face-stream")
+    {
+        StreamOptions stream;
+        stream.sources = parser.positionalArguments();
+        stream.camera = parser.isSet(cameraOption) ? parser.value(cameraOption).toInt() : -1;
+        stream.maxFrames = parser.value(framesOption).toInt();
+        stream.outputDir = parser.value(outOption);
+        stream.saveVideo = !parser.isSet(cutOnlyOption);
+        stream.face.fullScanInterval = std::max(1, parser.value(scanIntervalOption).toInt());
+        stream.face.face.workingSize = parser.value(faceSizeOption).toInt();
+        if (stream.outputDir.isEmpty() || (stream.sources.isEmpty() && stream.camera < 0))
+        {
+            std::cerr << "Error: face-stream needs --output and a video file or --camera" << std::endl;
+            return 2;
+        }
+        QDir().mkpath(stream.outputDir);
+        DetectorRegistry::instance().setModelDirectory(parser.value(modelsOption).toStdString());
+        int code = runFaceStream(stream);
+        writeTrace(tracePath);
+        return code;
+    }
+
+    BatchOptions options;
+    if (!parseOperation(parser.value(opOption), options.operation))
+    {
+        std::cerr << "Error: unknown or missing --op" << std::endl;
+        return 2;
+    }
+    if (!parseMethod(parser.value(methodOption), options.method))
+    {
+        std::cerr << "Error: unknown --method" << std::endl;
+        return 2;
+    }
+    if (!parser.isSet(outOption))
+    {
+        std::cerr << "Error: --output is required" << std::endl;
+        return 2;
+    }
+    if (options.operation == BATCH_TEMPLATE && !parser.isSet(refOption))
+    {
+        std::cerr << "Error: --ref is required for template search" << std::endl;
+        return 2;
+    }
+
+    bool recursive = parser.isSet(recursiveOption);
+    for (const QString &path : parser.positionalArguments())
+        collectInputs(path, recursive, options.inputs);
+
+    if (parser.isSet(listOption))
+    {
+        QFile list(parser.value(listOption));
+        if (!list.open(QIODevice::ReadOnly | QIODevice::Text))
+        {
+            std::cerr << "Error: Could not open list " << list.fileName().toStdString() << std::endl;
+            return 2;
+        }
+        QTextStream in(&list);
+        while (!in.atEnd())
+        {
+            QString line = in.readLine().trimmed();
+            if (!line.isEmpty()) options.inputs << line;
+        }
+    }
+
+    if (options.inputs.isEmpty())
+    {
+        std::cerr << "Error: no input images" << std::endl;
+        return 2;
+    }
+
+    options.outputDir = parser.value(outOption);
+    options.refPath = parser.value(refOption);
+    options.pyramidLevels = parser.value(pyramidOption).toInt();
+    options.pyramidCandidates = parser.value(candidatesOption).toInt();
+    if (parser.isSet(allMatchesOption)) options.matchThreshold = parser.value(allMatchesOption).toDouble();
+    options.tileThreads = parser.value(tileThreadsOption).toInt();
+    options.tileRows = parser.value(tileRowsOption).toInt();
+    options.faceWorkingSize = parser.value(faceSizeOption).toInt();
+    options.allFaces = parser.isSet(allFacesOption);
+    options.edgeKernel = parser.value(kernelOption).toInt();
+    options.grabcutScale = parser.value(grabcutScaleOption).toDouble();
+    options.grabcutBand = parser.value(grabcutBandOption).toInt();
+    options.tiledMegapixels = parser.value(tiledOption).toDouble();
+    options.workers = parser.value(jobsOption).toInt();
+    options.queueDepth = parser.value(queueOption).toInt();
+    options.format = parser.value(formatOption);
+    options.saveMarked = !parser.isSet(cutOnlyOption);
+
+    // 并行发生在图像级别，关闭OpenCV内部线程以免超额订阅
+    if (options.workers != 1) cv::setNumThreads(1);
+
+    if (options.operation == BATCH_FACE)
+    {
+        DetectorRegistry::instance().setModelDirectory(parser.value(modelsOption).toStdString());
+        if (!DetectorRegistry::instance().warmUp()) return 1;
+    }
+
+    BatchPipeline pipeline(options);
+    BatchStats stats = pipeline.run();
+    writeTrace(tracePath);
+
+    std::cerr << stats.processed << " processed, " << stats.failed << " failed in " << stats.seconds << " s";
+    if (stats.seconds > 0) std::cerr << " (" << stats.processed / stats.seconds << " images/s)";
+    std::cerr << std::endl;
+
+    return stats.failed == 0 ? 0 : 1;
+}
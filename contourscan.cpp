@@ -0,0 +1,184 @@
+#include "contourscan.h"
+
+// 8 邻域方向：东、东北、北、西北、西、西南、南、东南
+static const Point codeDeltas[8] = {{1, 0}, {1, -1}, {0, -1}, {-1, -1}, {-1, 0}, {-1, 1}, {0, 1}, {1, 1}};
+
+namespace
+{
+struct BorderStats
+{
+    int64 twiceArea = 0;  // 有向面积的两倍
+    int minX = INT_MAX, minY = INT_MAX, maxX = INT_MIN, maxY = INT_MIN;
+
+    void add(Point pt)
+    {
+        minX = std::min(minX, pt.x);
+        maxX = std::max(maxX, pt.x);
+        minY = std::min(minY, pt.y);
+        maxY = std::max(maxY, pt.y);
+    }
+};
+
+// 从 origin 处跟踪一条外边界，规则与 OpenCV 的 icvFetchContour 相同：途经的像素被标记
+// （右侧为背景的像素标为负值），CHAIN_APPROX_SIMPLE 只在方向改变时输出顶点。
+// points 为空指针时只统计面积和外接矩形
+class BorderFollower
+{
+public:
+    explicit BorderFollower(size_t step)
+    {
+        int s = static_cast<int>(step);
+        const int base[8] = {1, -s + 1, -s, -s - 1, -1, s - 1, s, s + 1};
+        for (int i = 0; i < 16; i++) deltas[i] = base[i & 7];
+    }
+
+    void follow(schar *origin, Point pt, BorderStats &stats, std::vector<Point> *points) const
+    {
+        const schar nbd = 2;
+        schar *i0 = origin, *i1, *i3, *i4 = nullptr;
+        int s, s_end, prev_s;
+
+        s_end = s = 4;
+        do
+        {
+            s = (s - 1) & 7;
+            i1 = i0 + deltas[s];
+        } while (*i1 == 0 && s != s_end);
+
+        if (s == s_end)
+        {
+            // 孤立像素
+            *i0 = static_cast<schar>(nbd | -128);
+            stats.add(pt);
+            if (points) points->push_back(pt);
+            return;
+        }
+
+        i3 = i0;
+        prev_s = s ^ 4;
+        for (;;)
+        {
+            s_end = s;
+            while (s < 15)
+            {
+                i4 = i3 + deltas[++s];
+                if (*i4 != 0) break;
+            }
+            s &= 7;
+
+            // 搜索经过了东侧的背景像素，说明是右边界
+            if (static_cast<unsigned>(s - 1) < static_cast<unsigned>(s_end))
+                *i3 = static_cast<schar>(nbd | -128);
+            else if (*i3 == 1)
+                *i3 = nbd;
+
+            if (s != prev_s)
+            {
+                if (points) points->push_back(pt);
+                prev_s = s;
+            }
+            stats.add(pt);
+
+            // 鞋带公式按链码逐步累计，与在压缩后的顶点上计算结果相同
+            Point next = pt + codeDeltas[s];
+            stats.twiceArea += static_cast<int64>(pt.x) * next.y - static_cast<int64>(next.x) * pt.y;
+            pt = next;
+
+            if (i4 == i0 && i3 == i1) break;
+
+            i3 = i4;
+            s = (s + 4) & 7;
+        }
+    }
+
+private:
+    int deltas[16];
+};
+}
+
+bool ContourScan::largestExternal(const Mat &binary, std::vector<Point> &contour, double *area, Rect *bbox)
+{
+    CV_Assert(binary.type() == CV_8UC1);
+    contour.clear();
+
+    // 二值化到 0/1 并在四周补一圈背景，跟踪时不必判断越界
+    Mat img(binary.rows + 2, binary.cols + 2, CV_8SC1, Scalar(0));
+    Mat inner = img(Rect(1, 1, binary.cols, binary.rows));
+    for (int y = 0; y < binary.rows; y++)
+    {
+        const uchar *src = binary.ptr(y);
+        schar *dst = inner.ptr<schar>(y);
+        for (int x = 0; x < binary.cols; x++) dst[x] = src[x] != 0;
+    }
+
+    BorderFollower follower(img.step);
+    const schar *img0 = img.ptr<schar>();
+    size_t step = img.step;
+    int width = img.cols - 1, height = img.rows - 1;
+
+    bool found = false;
+    int64 bestTwiceArea = -1;
+    Point bestOrigin;
+    BorderStats bestStats;
+
+    // 光栅扫描，lnbd 记录本行最近经过的已标记像素，用来判断新外边界是否位于已跟踪轮廓的内部
+    for (int y = 1; y < height; y++)
+    {
+        schar *row = img.ptr<schar>(y);
+        Point lnbd(0, y);
+        int prev = 0;
+        for (int x = 1; x < width; x++)
+        {
+            int p = row[x];
+            if (p == prev) continue;
+
+            bool isHole = false;
+            if (!(prev == 0 && p == 1))
+            {
+                if (p != 0 || prev < 1)
+                {
+                    prev = p;
+                    if (prev & -2) lnbd.x = x;
+                    continue;
+                }
+                if (prev & -2) lnbd.x = x - 1;
+                isHole = true;
+            }
+
+            // 只要外层轮廓：跳过孔洞以及位于已跟踪轮廓内部的外边界
+            if (isHole || img0[lnbd.y * step + lnbd.x] > 0)
+            {
+                prev = p;
+                if (prev & -2) lnbd.x = x;
+                continue;
+            }
+
+            BorderStats stats;
+            Point origin(x - 1, y - 1);
+            follower.follow(row + x, origin, stats, nullptr);
+
+            // findContours 按发现顺序的逆序输出，原实现取第一个最大者，即发现顺序中最后一个
+            int64 twiceArea = std::abs(stats.twiceArea);
+            if (twiceArea >= bestTwiceArea)
+            {
+                bestTwiceArea = twiceArea;
+                bestOrigin = origin;
+                bestStats = stats;
+                found = true;
+            }
+
+            prev = row[x];
+            if (prev & -2) lnbd.x = x;
+        }
+    }
+
+    if (!found) return false;
+
+    // 标记只会把非零值改成其它非零值，重新跟踪得到的路径与第一次相同
+    BorderStats stats;
+    follower.follow(img.ptr<schar>(bestOrigin.y + 1) + bestOrigin.x + 1, bestOrigin, stats, &contour);
+
+    if (area) *area = bestTwiceArea * 0.5;
+    if (bbox) *bbox = Rect(bestStats.minX, bestStats.minY, bestStats.maxX - bestStats.minX + 1, bestStats.maxY - bestStats.minY + 1);
+    return true;
+}
@@ -0,0 +1,19 @@
+#ifndef CONTOURSCAN_H
+#define CONTOURSCAN_H
+
+#include "opencv2/opencv.hpp"
+
+using namespace cv;
+
+// 最大外轮廓的流式提取：按 Suzuki 边界跟踪逐个扫描外轮廓，只累计面积和外接矩形，
+// 不保存各轮廓的点；扫描结束后只重新跟踪面积最大的一个。结果与
+// findContours(RETR_EXTERNAL, CHAIN_APPROX_SIMPLE) 后按 contourArea 取最大轮廓相同
+class ContourScan
+{
+public:
+    // binary 为单通道 8 位图，非零为前景；没有轮廓时返回 false
+    static bool largestExternal(const Mat &binary, std::vector<Point> &contour, double *area = nullptr,
+                                Rect *bbox = nullptr);
+};
+
+#endif // CONTOURSCAN_H
@@ -1,16 +1,64 @@
 #include "cvfunction.h"
+#include "detectorregistry.h"
+#include "templatematcher.h"
+#include "preparedtemplate.h"
+#include "fftmatcher.h"
+#include "tiledsource.h"
+#include "facedetector.h"
+#include "edgekernel.h"
+#include "contourscan.h"
+#include "grabcutsegmenter.h"
+#include "grabcutsession.h"
+#include "traceprobe.h"
 using namespace cv;
 
+// 归一化匹配结果并按匹配方法取最佳位置
+static Point bestMatchLoc(Mat &imgResult, Method METHOD)
+{
+    // 归一化匹配结果（可选）
+    TRACE_STAGE(stage, "template.normalize");
+    normalize(imgResult, imgResult, 0, 1, NORM_MINMAX, -1, Mat());
+
+    // 找到最佳匹配位置
+    TRACE_NEXT(stage, "template.minMaxLoc");
+    double minVal, maxVal;
+    Point minLoc, maxLoc;
+    minMaxLoc(imgResult, &minVal, &maxVal, &minLoc, &maxLoc, Mat());
+
+    // 根据匹配方法选择最佳匹配位置
+    if (METHOD == Method::TM_SQDIFF || METHOD == Method::TM_SQDIFF_NORMED)
+        return minLoc; // 平方差匹配法取最小值
+    else
+        return maxLoc; // 其他方法取最大值
+}
+
+// 在 dst 上框出匹配位置，并返回源图像中对应的区域
+static Mat markMatch(const ImageFrame &src, Mat &dst, Point matchLoc, Size size)
+{
+    TRACE_SCOPE("template.draw");
+    // 在源图像上绘制矩形框（注意：这里使用原始彩色图像进行绘制，而不是灰度图像）
+    rectangle(dst, matchLoc, Point(matchLoc.x + size.width, matchLoc.y + size.height), Scalar(0, 255, 0), 2); // 绿色矩形框
+
+    // 剪裁出匹配区域（从原始彩色图像中剪裁）
+    Rect matchedRegion(matchLoc, size); // 定义剪裁区域
+    Mat croppedRegion = src.mat()(matchedRegion); // 从源图像中剪裁出区域
+
+    // 返回剪裁出的区域
+    return croppedRegion;
+}
+
 CVFunction::CVFunction() {}
 
 CVFunction::~CVFunction() {}
 
-Mat CVFunction::templateSearch(const Mat &src, const Mat &ref, Mat &dst, Method METHOD)
+Mat CVFunction::templateSearch(const ImageFrame &src, const ImageFrame &ref, Mat &dst, Method METHOD)
 {
-    // 将源图像和参考图像转换为灰度图像
-    Mat srcGray, refGray;
-    cvtColor(src, srcGray, COLOR_RGB2GRAY);
-    cvtColor(ref, refGray, COLOR_RGB2GRAY);
+    TRACE_SCOPE("templateSearch");
+
+    // 取源图像和参考图像的灰度平面（已缓存时不再转换）
+    TRACE_STAGE(stage, "template.cvtColor");
+    const Mat &srcGray = src.gray();
+    const Mat &refGray = ref.gray();
 
     // 创建匹配结果矩阵
     Mat imgResult;
@@ -19,133 +67,148 @@ Mat CVFunction::templateSearch(const Mat &src, const Mat &ref, Mat &dst, Method
     imgResult.create(resRows, resCols, CV_32FC1);
 
     // 执行模板匹配
+    TRACE_NEXT(stage, "template.matchTemplate");
     matchTemplate(srcGray, refGray, imgResult, METHOD);
+    TRACE_END(stage);
 
-    // 归一化匹配结果（可选）
-    normalize(imgResult, imgResult, 0, 1, NORM_MINMAX, -1, Mat());
+    Point matchLoc = bestMatchLoc(imgResult, METHOD);
+    return markMatch(src, dst, matchLoc, ref.size());
+}
 
-    // 找到最佳匹配位置
-    double minVal, maxVal;
-    Point minLoc, maxLoc, matchLoc;
-    minMaxLoc(imgResult, &minVal, &maxVal, &minLoc, &maxLoc, Mat());
+Mat CVFunction::templateSearch(const ImageFrame &src, const PreparedTemplate &ref, Mat &dst, Method METHOD)
+{
+    TRACE_SCOPE("templateSearch.prepared");
 
-    // 根据匹配方法选择最佳匹配位置
-    if (METHOD == Method::TM_SQDIFF || METHOD == Method::TM_SQDIFF_NORMED)
-        matchLoc = minLoc; // 平方差匹配法取最小值
-    else
-        matchLoc = maxLoc; // 其他方法取最大值
+    // 模板的灰度数据、统计量和频谱已经缓存，源图的灰度平面同样取自缓存
+    TRACE_STAGE(stage, "template.cvtColor");
+    const Mat &srcGray = src.gray();
 
-    // 在源图像上绘制矩形框（注意：这里使用原始彩色图像进行绘制，而不是灰度图像）
-    rectangle(dst, matchLoc, Point(matchLoc.x + ref.cols, matchLoc.y + ref.rows), Scalar(0, 255, 0), 2); // 绿色矩形框
+    TRACE_NEXT(stage, "template.matchTemplate");
+    Mat imgResult;
+    ref.match(srcGray, imgResult, METHOD);
+    TRACE_END(stage);
 
-    // 剪裁出匹配区域（从原始彩色图像中剪裁）
-    Rect matchedRegion(matchLoc, Size(ref.cols, ref.rows)); // 定义剪裁区域
-    Mat croppedRegion = src(matchedRegion);                // 从源图像中剪裁出区域
+    Point matchLoc = bestMatchLoc(imgResult, METHOD);
+    return markMatch(src, dst, matchLoc, ref.size());
+}
 
-    // 返回剪裁出的区域
-    return croppedRegion;
+Mat CVFunction::templateSearch(const ImageFrame &src, const ImageFrame &ref, Mat &dst, Method METHOD, const PyramidOptions &pyramid)
+{
+    TRACE_SCOPE("templateSearch.pyramid");
+    TRACE_STAGE(stage, "template.cvtColor");
+    const Mat &srcGray = src.gray();
+    const Mat &refGray = ref.gray();
+
+    // 金字塔由粗到细定位，结果与全分辨率匹配的 matchLoc 误差在一个像素内
+    TRACE_NEXT(stage, "template.pyramidLocate");
+    MatchCandidate best;
+    if (!TemplateMatcher::pyramidLocate(srcGray, refGray, METHOD, pyramid, best)) return Mat();  // 已中止
+    TRACE_END(stage);
+    return markMatch(src, dst, best.loc, ref.size());
 }
 
-void CVFunction::track(const Mat &ref)
+Mat CVFunction::templateSearch(const ImageFrame &src, const ImageFrame &ref, Mat &dst, Method METHOD, const TiledOptions &tiled)
 {
-    // 初始化摄像头
-    cv::VideoCapture cap(0);
-    if (!cap.isOpened())
-    {
-        std::cerr << "Error: Could not open camera" << std::endl;
-        return;
-    }
+    TRACE_SCOPE("templateSearch.tiled");
+    TRACE_STAGE(stage, "template.cvtColor");
+    const Mat &srcGray = src.gray();
+    const Mat &refGray = ref.gray();
 
-    // ORB 特征检测器和描述符
-    cv::Ptr<cv::ORB> orb = cv::ORB::create();
-    cv::BFMatcher bf(cv::NORM_HAMMING, true);
+    // 多线程分条带计算得分图，得分与整图计算只差浮点舍入（见 TemplateMatcher::tiledMatch），后续归一化和取极值不变
+    TRACE_NEXT(stage, "template.tiledMatch");
+    Mat imgResult;
+    if (!TemplateMatcher::tiledMatch(srcGray, refGray, imgResult, METHOD, tiled)) return Mat();  // 已中止
+    TRACE_END(stage);
 
-    // 计算参考图像的关键点和描述符
-    std::vector<cv::KeyPoint> kp_ref;
-    Mat des_ref;
-    orb->detectAndCompute(ref, cv::Mat(), kp_ref, des_ref);
+    Point matchLoc = bestMatchLoc(imgResult, METHOD);
+    return markMatch(src, dst, matchLoc, ref.size());
+}
 
-    while (true)
-    {
-        Mat frame;
-        cap >> frame;
-        if (frame.empty()) break;
-
-        // 检测当前帧的关键点和描述符
-        std::vector<cv::KeyPoint> kp_frame;
-        Mat des_frame;
-        orb->detectAndCompute(frame, cv::Mat(), kp_frame, des_frame);
-
-        if (!des_frame.empty() && !des_ref.empty()) {
-            // 匹配特征点
-            std::vector<cv::DMatch> matches;
-            bf.match(des_ref, des_frame, matches);
-            std::sort(matches.begin(), matches.end(), [](const cv::DMatch& a, const cv::DMatch& b) {
-                    return a.distance < b.distance;
-            });
-
-            // 提取匹配点的位置
-            std::vector<cv::Point2f> src_pts, dst_pts;
-            for (size_t i = 0; i < matches.size(); ++i)
-            {
-                src_pts.push_back(kp_ref[matches[i].queryIdx].pt);
-                dst_pts.push_back(kp_frame[matches[i].trainIdx].pt);
-            }
-
-            if (src_pts.size() > 4)
-            {
-                // 计算单应性矩阵并绘制边界框
-                Mat H = cv::findHomography(src_pts, dst_pts, cv::RANSAC, 5.0);
-                std::vector<cv::Point2f> pts = {cv::Point2f(0, 0), cv::Point2f(0, ref.rows - 1),
-                                                    cv::Point2f(ref.cols - 1, ref.rows - 1), cv::Point2f(ref.cols - 1, 0)};
-                std::vector<cv::Point2f> dst;
-                cv::perspectiveTransform(pts, dst, H);
-                std::vector<cv::Point> dst_int;
-                for (const auto& pt : dst) dst_int.emplace_back(static_cast<int>(pt.x), static_cast<int>(pt.y));
-                cv::polylines(frame, dst_int, true, cv::Scalar(0, 255, 0), 3);
-            }
-        }
+Mat CVFunction::templateSearch(const ImageFrame &src, FftMatcher &matcher, Mat &dst, Method METHOD)
+{
+    TRACE_SCOPE("templateSearch.fft");
 
-        // 显示结果
-        imshow("ORB Tracking", frame);
-        if (cv::waitKey(30) >= 0) break;
-    }
+    // 源图尺寸变化时重新准备 DFT 计划和缓冲，同尺寸的后续调用不再分配
+    if (src.size() != matcher.sourceSize()) matcher.resize(src.size());
+    TRACE_STAGE(stage, "template.fftMatch");
+    Mat imgResult = matcher.match(src.gray(), METHOD);
+    TRACE_END(stage);
 
+    Point matchLoc = bestMatchLoc(imgResult, METHOD);
+    return markMatch(src, dst, matchLoc, matcher.templateSize());
+}
 
-    // 释放资源
-    cap.release();
-    destroyAllWindows();
+Mat CVFunction::templateSearch(const TiledImageSource &src, const PreparedTemplate &ref, Method METHOD,
+                               const TiledSourceOptions &options, Rect *match)
+{
+    // 整图不进入内存，无法在 dst 上标注；只返回匹配区域的 RGB 副本，位置通过 match 输出
+    TRACE_SCOPE("templateSearch.tiled");
+    MatchCandidate best;
+    if (!TiledProcessor::locate(src, ref, METHOD, options, best)) return Mat();
+
+    Rect region(best.loc, ref.size());
+    if (match) *match = region;
+    return src.readRGB(region);
 }
 
+Mat CVFunction::templateSearchAll(const ImageFrame &src, const ImageFrame &ref, Mat &dst, Method METHOD,
+                                  const MultiMatchOptions &options, std::vector<MatchCandidate> &matches)
+{
+    TRACE_SCOPE("templateSearchAll");
+    TRACE_STAGE(stage, "template.cvtColor");
+    const Mat &srcGray = src.gray();
+    const Mat &refGray = ref.gray();
 
-Mat CVFunction::faceSearch(const Mat &src, Mat &dst)
+    TRACE_NEXT(stage, "template.matchTemplate");
+    Mat imgResult;
+    matchTemplate(srcGray, refGray, imgResult, METHOD);
+
+    // 对得分图做一次并行峰值扫描和分桶非极大值抑制，得到全部匹配
+    TRACE_NEXT(stage, "template.findAll");
+    Mat scores = TemplateMatcher::scoreMap(imgResult, METHOD);
+    matches = TemplateMatcher::findAll(scores, ref.size(), options);
+    if (matches.empty())
+        return Mat();
+
+    TRACE_NEXT(stage, "template.draw");
+    for (const MatchCandidate &m : matches)
+        rectangle(dst, Rect(m.loc, ref.size()), Scalar(0, 255, 0), 2); // 绿色矩形框
+
+    // 返回得分最高的匹配区域
+    return src.mat()(Rect(matches.front().loc, ref.size()));
+}
+
+Mat CVFunction::faceSearch(const ImageFrame &src, Mat &dst)
 {
-    Mat imgCut = src.clone(); // 用于显示最终结果
+    TRACE_SCOPE("faceSearch");
+    Mat imgCut = src.mat(); // 未检测到人脸时返回整幅原图（视图，不复制）
 
-    // 初始化人脸和眼睛检测器
-    CascadeClassifier face_detector;
-    CascadeClassifier eyes_detector;
+    // 从注册表租借人脸和眼睛检测器（XML只在首次使用时解析）
+    DetectorRegistry::Lease face_detector = DetectorRegistry::instance().acquire(CASCADE_FRONTAL_FACE);
+    DetectorRegistry::Lease eyes_detector = DetectorRegistry::instance().acquire(CASCADE_EYE_GLASSES);
 
     // 检查分类器是否加载成功
-    if (!face_detector.load("release/haarcascade_frontalface_alt.xml"))
+    if (!face_detector)
     {
         std::cerr << "Error: Could not load face detector." << std::endl;
         return imgCut; // 返回原始图像
     }
-    if (!eyes_detector.load("release/haarcascade_eye_tree_eyeglasses.xml"))
+    if (!eyes_detector)
     {
         std::cerr << "Error: Could not load eyes detector." << std::endl;
         return imgCut; // 返回原始图像
     }
 
-    // 转换为灰度图并进行直方图均衡化
+    // 取灰度图并进行直方图均衡化（写入新缓冲，缓存的灰度平面保持不变）
+    TRACE_STAGE(stage, "face.cvtColor");
     Mat imgGray;
-    cvtColor(src, imgGray, COLOR_RGB2GRAY);
-    equalizeHist(imgGray, imgGray);
+    equalizeHist(src.gray(), imgGray);
 
     // 检测人脸
+    TRACE_NEXT(stage, "face.detectFaces");
     std::vector<Rect> faces;
-    face_detector.detectMultiScale(imgGray, faces, 1.1, 2, 0 | CASCADE_SCALE_IMAGE, Size(30, 30));
+    face_detector->detectMultiScale(imgGray, faces, 1.1, 2, 0 | CASCADE_SCALE_IMAGE, Size(30, 30));
+    TRACE_END(stage);
 
     // 如果未检测到人脸，直接返回原始图像
     if (faces.empty())
@@ -156,7 +219,7 @@ Mat CVFunction::faceSearch(const Mat &src, Mat &dst)
 
     // 剪裁出第一张人脸区域
     Rect faceRegion = faces[0]; // 取第一个检测到的人脸
-    Mat croppedFace = src(faceRegion); // 剪裁出人脸区域
+    Mat croppedFace = src.mat()(faceRegion); // 剪裁出人脸区域
 
     // 在 dst 图像上绘制标记（使用矩形框）
     for (size_t i = 0; i < faces.size(); i++)
@@ -165,9 +228,10 @@ Mat CVFunction::faceSearch(const Mat &src, Mat &dst)
         rectangle(dst, faces[i], Scalar(0, 255, 0), 2); // 绿色矩形框
 
         // 在人脸区域内检测眼睛
+        TRACE_SCOPE("face.detectEyes");
         Mat faceROI = imgGray(faces[i]);
         std::vector<Rect> eyes;
-        eyes_detector.detectMultiScale(faceROI, eyes, 1.1, 2, 0 | CASCADE_SCALE_IMAGE, Size(30, 30));
+        eyes_detector->detectMultiScale(faceROI, eyes, 1.1, 2, 0 | CASCADE_SCALE_IMAGE, Size(30, 30));
 
         // 遍历检测到的眼睛
         for (size_t j = 0; j < eyes.size(); j++)
@@ -176,7 +240,7 @@ Mat CVFunction::faceSearch(const Mat &src, Mat &dst)
             Rect eyeRect(faces[i].x + eyes[j].x, faces[i].y + eyes[j].y, eyes[j].width, eyes[j].height);
 
             // 绘制矩形框标记眼睛
-            rectangle(dst, eyeRect, Scalar(255, 0, 0), 2); // 蓝色矩形框
+            rectangle(dst, eyeRect, src.color(255, 0, 0), 2); // 蓝色矩形框
         }
     }
 
@@ -185,47 +249,145 @@ Mat CVFunction::faceSearch(const Mat &src, Mat &dst)
 }
 
 
-Mat CVFunction::edgeDetection(const Mat& src, Mat& dst, int kernel_size)
+Mat CVFunction::faceSearch(const ImageFrame &src, Mat &dst, const FaceOptions &options)
 {
-    // 转换为灰度图
-    Mat srcGray;
-    cvtColor(src, srcGray, COLOR_RGB2GRAY);
-
-    // 执行边缘检测（Sobel）
-    Mat grad_x, grad_y;
-    Sobel(srcGray, grad_x, CV_32F, 1, 0, kernel_size);
-    Sobel(srcGray, grad_y, CV_32F, 0, 1, kernel_size);
-
-    // 取绝对值并合并梯度
-    Mat abs_grad_x, abs_grad_y, edges;
-    convertScaleAbs(grad_x, abs_grad_x);
-    convertScaleAbs(grad_y, abs_grad_y);
-    addWeighted(abs_grad_x, 0.5, abs_grad_y, 0.5, 0, edges);
-
-    // 使用Canny算法从Sobel结果中提取边缘（转化为二值图像）
-    Mat canny_output;
-    Canny(edges, canny_output, 50, 150); // 调整阈值以适应你的需求
+    TRACE_SCOPE("faceSearch");
+    DetectorRegistry::Lease face_detector = DetectorRegistry::instance().acquire(CASCADE_FRONTAL_FACE);
+    DetectorRegistry::Lease eyes_detector = DetectorRegistry::instance().acquire(CASCADE_EYE_GLASSES);
+    if (!face_detector)
+    {
+        std::cerr << "Error: Could not load face detector." << std::endl;
+        return src.mat();
+    }
+    if (!eyes_detector)
+    {
+        std::cerr << "Error: Could not load eyes detector." << std::endl;
+        return src.mat();
+    }
 
-    // 寻找轮廓
-    std::vector<std::vector<Point>> contours;
-    std::vector<Vec4i> hierarchy;
-    findContours(canny_output, contours, hierarchy, RETR_EXTERNAL, CHAIN_APPROX_SIMPLE);
+    // 人脸在工作分辨率上检测，眼睛在原始分辨率的人脸区域上检测
+    TRACE_STAGE(stage, "face.cvtColor");
+    const Mat &imgGray = src.gray();
+    TRACE_NEXT(stage, "face.detectFaces");
+    std::vector<Rect> faces = FaceDetector::detectFaces(*face_detector, imgGray, options);
+    TRACE_END(stage);
+    // 级联扫描本身无法中途退出，只能在人脸检测之后和每张人脸之间检查；中止时返回空图
+    if (options.progress && !options.progress(0.5)) return Mat();
+    if (faces.empty())
+    {
+        std::cerr << "No faces detected." << std::endl;
+        return src.mat();
+    }
 
-    if (contours.empty()) {
-        // 如果没有找到任何轮廓，则复制原始图像到dst或者采取其他措施
-        src.copyTo(dst);
-        return src;
+    for (size_t i = 0; i < faces.size(); i++)
+    {
+        TRACE_SCOPE("face.detectEyes");
+        rectangle(dst, faces[i], Scalar(0, 255, 0), 2); // 绿色矩形框
+        for (const Rect &eye : FaceDetector::detectEyes(*eyes_detector, imgGray, faces[i], options))
+            rectangle(dst, eye, src.color(255, 0, 0), 2); // 蓝色矩形框
+        if (options.progress && !options.progress(0.5 + 0.5 * (i + 1) / faces.size())) return Mat();
     }
 
-    // 寻找最大的轮廓（假设是我们感兴趣的区域）
-    double maxArea = 0;
-    int maxIdx = 0;
-    for (int i = 0; i < contours.size(); i++) {
-        double area = contourArea(contours[i]);
-        if (area > maxArea) {
-            maxArea = area;
-            maxIdx = i;
-        }
+    return src.mat()(faces[0]);
+}
+
+
+std::vector<FaceResult> CVFunction::faceSearchAll(const ImageFrame &src, Mat &dst, const FaceOptions &options)
+{
+    TRACE_SCOPE("faceSearchAll");
+    std::vector<FaceResult> results;
+    DetectorRegistry::Lease face_detector = DetectorRegistry::instance().acquire(CASCADE_FRONTAL_FACE);
+    if (!face_detector)
+    {
+        std::cerr << "Error: Could not load face detector." << std::endl;
+        return results;
+    }
+
+    TRACE_STAGE(stage, "face.cvtColor");
+    const Mat &imgGray = src.gray();
+    TRACE_NEXT(stage, "face.detectFaces");
+    std::vector<Rect> faces = FaceDetector::detectFaces(*face_detector, imgGray, options);
+    TRACE_END(stage);
+    face_detector = DetectorRegistry::Lease();  // 提前归还，眼睛检测期间不再需要
+    if (options.progress && !options.progress(0.5)) return results;  // 中止时不返回任何人脸
+    if (faces.empty())
+    {
+        std::cerr << "No faces detected." << std::endl;
+        return results;
+    }
+
+    for (const Rect &face : faces)
+    {
+        FaceResult result;
+        result.face = face;
+        result.crop = src.mat()(face);
+        results.push_back(result);
+    }
+
+    // 各人脸的眼睛检测互不相关，并行执行
+    TRACE_NEXT(stage, "face.detectEyes");
+    bool aborted = false;
+    if (!FaceDetector::detectEyesParallel(imgGray, results, options, &aborted))
+        std::cerr << "Error: Could not load eyes detector." << std::endl;
+    if (aborted)
+    {
+        results.clear();
+        return results;
+    }
+    TRACE_NEXT(stage, "face.draw");
+
+    for (const FaceResult &result : results)
+    {
+        rectangle(dst, result.face, Scalar(0, 255, 0), 2); // 绿色矩形框
+        for (const Rect &eye : result.eyes)
+            rectangle(dst, eye, src.color(255, 0, 0), 2); // 蓝色矩形框
+    }
+    return results;
+}
+
+
+Mat CVFunction::edgeDetection(const ImageFrame &src, Mat &dst, int kernel_size)
+{
+    TRACE_SCOPE("edgeDetection");
+    TRACE_STAGE(stage, "edge.canny");
+    Mat canny_output;
+    if (kernel_size == 3)
+    {
+        // 3x3 核使用融合实现，结果与下面的逐步计算完全相同；
+        // 灰度平面已由其他操作算出时直接读取，否则在条带内按 src 的通道顺序转换，不生成整幅灰度图
+        if (src.hasGray())
+            EdgeKernel::detect(src.gray(), canny_output, 50, 150);
+        else
+            EdgeKernel::detect(src.mat(), canny_output, 50, 150, 0, src.grayCode());
+    }
+    else
+    {
+        // 灰度图
+        const Mat &srcGray = src.gray();
+
+        // 执行边缘检测（Sobel）
+        Mat grad_x, grad_y;
+        Sobel(srcGray, grad_x, CV_32F, 1, 0, kernel_size);
+        Sobel(srcGray, grad_y, CV_32F, 0, 1, kernel_size);
+
+        // 取绝对值并合并梯度
+        Mat abs_grad_x, abs_grad_y, edges;
+        convertScaleAbs(grad_x, abs_grad_x);
+        convertScaleAbs(grad_y, abs_grad_y);
+        addWeighted(abs_grad_x, 0.5, abs_grad_y, 0.5, 0, edges);
+
+        // 使用Canny算法从Sobel结果中提取边缘（转化为二值图像）
+        Canny(edges, canny_output, 50, 150); // 调整阈值以适应你的需求
+    }
+
+    // 单遍扫描寻找最大的外轮廓（假设是我们感兴趣的区域），其余轮廓的点不保存
+    TRACE_NEXT(stage, "edge.contour");
+    std::vector<std::vector<Point>> largest(1);
+    Rect boundingBox;
+    if (!ContourScan::largestExternal(canny_output, largest[0], nullptr, &boundingBox)) {
+        // 如果没有找到任何轮廓，则复制原始图像到dst或者采取其他措施
+        src.mat().copyTo(dst);
+        return src.mat();
     }
 
     // 设置颜色和厚度
@@ -233,90 +395,93 @@ Mat CVFunction::edgeDetection(const Mat& src, Mat& dst, int kernel_size)
     int thickness = 2;
 
     // 在dst图像上绘制最大轮廓
-    drawContours(dst, contours, maxIdx, color, thickness);
+    TRACE_NEXT(stage, "edge.draw");
+    drawContours(dst, largest, 0, color, thickness);
 
     // 如果需要剪裁出感兴趣区域，可以在绘制轮廓后进行
-    Rect boundingBox = boundingRect(contours[maxIdx]);
-    Mat croppedImage = src(boundingBox);
+    Mat croppedImage = src.mat()(boundingBox);
 
     return croppedImage;
 }
 
-Mat CVFunction::grabcutForegroundExtraction(const Mat& src, Mat& dst)
+Mat CVFunction::edgeDetection(const TiledImageSource &src, const QString &edgePath, const TiledSourceOptions &options,
+                              Rect *bbox)
 {
-    // 初始矩形区域：图像中心缩小80%
-    int margin = 20;
-    Rect rect(margin, margin, src.cols - 2 * margin, src.rows - 2 * margin);
-
-    // 初始化 mask
-    Mat mask(src.size(), CV_8UC1, Scalar(GC_BGD));
-    mask(rect).setTo(Scalar(GC_PR_FGD));
-
-    // 初始化模型
-    Mat bgModel, fgModel;
-
-    // 执行 GrabCut 分割
-    grabCut(src, mask, rect, bgModel, fgModel, 5, GC_INIT_WITH_RECT);
+    // 边缘图写入 edgePath，返回最大轮廓外接区域的 RGB 副本（受分块大小限制，不会是整图）
+    TRACE_SCOPE("edgeDetection.tiled");
+    std::vector<Point> largest;
+    Rect boundingBox;
+    if (!TiledProcessor::edgeMap(src, edgePath, options, largest, boundingBox)) return Mat();
+
+    if (bbox) *bbox = boundingBox;
+    return src.readRGB(boundingBox);
+}
 
+// 由 GrabCut 标签提取前景，在 dst 上绘制最大轮廓并返回其外接区域
+static Mat cropForeground(const Mat &src, const Mat &mask, Mat &dst)
+{
     // 转换为前景掩码
+    TRACE_STAGE(stage, "grabcut.contour");
     Mat foregroundMask = (mask == GC_FGD) | (mask == GC_PR_FGD);
 
-    // 提取前景图像
-    Mat foreground;
-    src.copyTo(foreground, foregroundMask);
-
     // 查找最大轮廓（便于裁剪）
-    std::vector<std::vector<Point>> contours;
-    findContours(foregroundMask, contours, RETR_EXTERNAL, CHAIN_APPROX_SIMPLE);
-
-    if (contours.empty()) {
+    std::vector<std::vector<Point>> largest(1);
+    Rect bbox;
+    if (!ContourScan::largestExternal(foregroundMask, largest[0], nullptr, &bbox)) {
         src.copyTo(dst);
         return src;
     }
 
-    // 找最大轮廓
-    int maxIdx = 0;
-    double maxArea = 0;
-    for (int i = 0; i < contours.size(); ++i) {
-        double area = contourArea(contours[i]);
-        if (area > maxArea) {
-            maxArea = area;
-            maxIdx = i;
-        }
-    }
-
-    Rect bbox = boundingRect(contours[maxIdx]);
-    Mat cropped = src(bbox).clone();
+    Mat cropped = src(bbox);
 
     // 可视化：绘制最大轮廓
+    TRACE_NEXT(stage, "grabcut.draw");
     src.copyTo(dst);
-    drawContours(dst, contours, maxIdx, Scalar(0, 255, 0), 2);
+    drawContours(dst, largest, 0, Scalar(0, 255, 0), 2);
 
     return cropped;
 }
 
+Mat CVFunction::grabcutForegroundExtraction(const ImageFrame &frame, Mat &dst)
+{
+    TRACE_SCOPE("grabcutForegroundExtraction");
+    // GrabCut 的颜色模型与通道顺序无关，直接使用原始像素
+    const Mat &src = frame.mat();
+    // 初始矩形区域：图像中心缩小80%
+    int margin = 20;
+    Rect rect(margin, margin, src.cols - 2 * margin, src.rows - 2 * margin);
 
+    // 初始化 mask
+    Mat mask(src.size(), CV_8UC1, Scalar(GC_BGD));
+    mask(rect).setTo(Scalar(GC_PR_FGD));
 
+    // 初始化模型
+    Mat bgModel, fgModel;
 
+    // 执行 GrabCut 分割
+    {
+        TRACE_SCOPE("grabcut.grabCut");
+        grabCut(src, mask, rect, bgModel, fgModel, 5, GC_INIT_WITH_RECT);
+    }
 
+    return cropForeground(src, mask, dst);
+}
 
+Mat CVFunction::grabcutForegroundExtraction(const ImageFrame &frame, Mat &dst, const GrabCutOptions &options)
+{
+    // 由粗到细分割，scale 为 1 时与上面的全分辨率版本相同；被进度回调中止时返回空图像
+    TRACE_SCOPE("grabcutForegroundExtraction");
+    const Mat &src = frame.mat();
+    Mat mask;
+    if (!GrabCutSegmenter::segment(src, mask, options)) return Mat();
+    return cropForeground(src, mask, dst);
+}
 
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
+Mat CVFunction::grabcutForegroundExtraction(const ImageFrame &frame, Mat &dst, GrabCutSession &session, int iterations)
+{
+    // 会话已开始时只在保留的掩码和模型上追加迭代
+    TRACE_SCOPE("grabcutForegroundExtraction.session");
+    const Mat &src = frame.mat();
+    if (session.run(src, iterations) == 0) return Mat();
+    return cropForeground(src, session.labels(), dst);
+}
@@ -3,10 +3,16 @@
 
 #include "opencv2/opencv.hpp"
 #include "opencv2/features2d.hpp"
+#include "imageframe.h"
 #include <QString>
+#include <functional>
 
 using namespace cv;
 
+// 长时间操作的进度回调，参数为已完成的比例（0~1），返回 false 时操作在下一个检查点中止；
+// 可能在多个工作线程中同时调用
+using ProgressCallback = std::function<bool(double done)>;
+
 enum Method
 {
     TM_SQDIFF,
@@ -17,16 +23,45 @@ enum Method
     TM_CCOEFF_NORMED,
 };
 
+struct PyramidOptions;
+struct TiledOptions;
+struct MultiMatchOptions;
+struct MatchCandidate;
+class PreparedTemplate;
+class FftMatcher;
+class TiledImageSource;
+struct TiledSourceOptions;
+struct FaceOptions;
+struct FaceResult;
+struct GrabCutOptions;
+class GrabCutSession;
+
 class CVFunction
 {
 public:
     CVFunction();
     ~CVFunction();
 
-    static Mat templateSearch(const Mat &src, const Mat &ref, Mat &dst, Method METHOD);
-    static void track(const Mat &ref);
-    static Mat faceSearch(const Mat &src, Mat &dst);
-    static Mat edgeDetection(const Mat& src, Mat& dst, int kernel_size);
-    static Mat grabcutForegroundExtraction(const Mat& src, Mat& dst);
+    // src 和 ref 的灰度平面取自 ImageFrame 的缓存，同一张图上的多次操作只转换一次；
+    // 标注按 src 的通道顺序画在 dst（src 的副本）上，返回的剪裁是 src 的视图，通道顺序与 src 相同。
+    // 带选项的重载在选项的进度回调要求中止时返回空图（faceSearchAll 返回空列表），dst 可能只画了一部分
+    static Mat templateSearch(const ImageFrame &src, const ImageFrame &ref, Mat &dst, Method METHOD);
+    static Mat templateSearch(const ImageFrame &src, const ImageFrame &ref, Mat &dst, Method METHOD, const PyramidOptions &pyramid);
+    static Mat templateSearch(const ImageFrame &src, const PreparedTemplate &ref, Mat &dst, Method METHOD);
+    static Mat templateSearch(const ImageFrame &src, const ImageFrame &ref, Mat &dst, Method METHOD, const TiledOptions &tiled);
+    static Mat templateSearch(const ImageFrame &src, FftMatcher &matcher, Mat &dst, Method METHOD);
+    static Mat templateSearch(const TiledImageSource &src, const PreparedTemplate &ref, Method METHOD,
+                              const TiledSourceOptions &options, Rect *match = nullptr);
+    static Mat templateSearchAll(const ImageFrame &src, const ImageFrame &ref, Mat &dst, Method METHOD,
+                                 const MultiMatchOptions &options, std::vector<MatchCandidate> &matches);
+    static Mat faceSearch(const ImageFrame &src, Mat &dst);
+    static Mat faceSearch(const ImageFrame &src, Mat &dst, const FaceOptions &options);
+    static std::vector<FaceResult> faceSearchAll(const ImageFrame &src, Mat &dst, const FaceOptions &options);
+    static Mat edgeDetection(const ImageFrame &src, Mat &dst, int kernel_size);
+    static Mat edgeDetection(const TiledImageSource &src, const QString &edgePath, const TiledSourceOptions &options,
+                             Rect *bbox = nullptr);
+    static Mat grabcutForegroundExtraction(const ImageFrame &frame, Mat &dst);
+    static Mat grabcutForegroundExtraction(const ImageFrame &frame, Mat &dst, const GrabCutOptions &options);
+    static Mat grabcutForegroundExtraction(const ImageFrame &frame, Mat &dst, GrabCutSession &session, int iterations = 1);
 };
 #endif // CVFUNCTION_H
@@ -0,0 +1,138 @@
+#include "detectorregistry.h"
+
+DetectorRegistry::Lease::Lease(Lease &&other) noexcept
+    : model(other.model)
+    , generation(other.generation)
+    , classifier(std::move(other.classifier))
+{
+}
+
+DetectorRegistry::Lease &DetectorRegistry::Lease::operator=(Lease &&other) noexcept
+{
+    if (this != &other)
+    {
+        giveBack();
+        model = other.model;
+        generation = other.generation;
+        classifier = std::move(other.classifier);
+    }
+    return *this;
+}
+
+DetectorRegistry::Lease::~Lease()
+{
+    giveBack();
+}
+
+void DetectorRegistry::Lease::giveBack()
+{
+    if (classifier)
+        DetectorRegistry::instance().release(*this);
+}
+
+DetectorRegistry::DetectorRegistry()
+    : modelDir("release")
+{
+}
+
+DetectorRegistry &DetectorRegistry::instance()
+{
+    static DetectorRegistry registry;
+    return registry;
+}
+
+const char *DetectorRegistry::fileName(CascadeModel model)
+{
+    switch (model)
+    {
+    case CASCADE_FRONTAL_FACE: return "haarcascade_frontalface_alt.xml";
+    case CASCADE_EYE_GLASSES:  return "haarcascade_eye_tree_eyeglasses.xml";
+    default:                   return "";
+    }
+}
+
+void DetectorRegistry::setModelDirectory(const std::string &dir)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (dir == modelDir) return;
+
+    // 更换目录后丢弃已解析的模型，仍在使用中的实例归还时直接释放
+    modelDir = dir;
+    ++generation;
+    for (Slot &slot : slots)
+    {
+        slot.storage.release();
+        slot.idle.clear();
+    }
+}
+
+std::string DetectorRegistry::modelDirectory() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return modelDir;
+}
+
+bool DetectorRegistry::warmUp()
+{
+    bool ok = true;
+    for (int i = 0; i < CASCADE_MODEL_COUNT; i++)
+    {
+        Lease lease = acquire(static_cast<CascadeModel>(i));
+        if (!lease)
+        {
+            std::cerr << "Error: Could not load " << fileName(static_cast<CascadeModel>(i)) << std::endl;
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+DetectorRegistry::Lease DetectorRegistry::acquire(CascadeModel model)
+{
+    Lease lease;
+    if (model < 0 || model >= CASCADE_MODEL_COUNT) return lease;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    Slot &slot = slots[model];
+    if (!slot.idle.empty())
+    {
+        lease.classifier = std::move(slot.idle.back());
+        slot.idle.pop_back();
+    }
+    else
+    {
+        lease.classifier = createLocked(model);
+    }
+
+    if (lease.classifier)
+    {
+        lease.model = model;
+        lease.generation = generation;
+    }
+    return lease;
+}
+
+std::unique_ptr<CascadeClassifier> DetectorRegistry::createLocked(CascadeModel model)
+{
+    Slot &slot = slots[model];
+    if (!slot.storage.isOpened())
+    {
+        std::string path = modelDir.empty() ? fileName(model) : modelDir + "/" + fileName(model);
+        if (!slot.storage.open(path, FileStorage::READ))
+            return nullptr;
+    }
+
+    // 从已解析的节点树构建分类器，不再重复读取磁盘和解析XML
+    auto classifier = std::make_unique<CascadeClassifier>();
+    if (!classifier->read(slot.storage.getFirstTopLevelNode()))
+        return nullptr;
+    return classifier;
+}
+
+void DetectorRegistry::release(Lease &lease)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (lease.generation == generation)
+        slots[lease.model].idle.push_back(std::move(lease.classifier));
+    lease.classifier.reset();
+}
@@ -0,0 +1,71 @@
+#ifndef DETECTORREGISTRY_H
+#define DETECTORREGISTRY_H
+
+#include "opencv2/opencv.hpp"
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+using namespace cv;
+
+enum CascadeModel
+{
+    CASCADE_FRONTAL_FACE,
+    CASCADE_EYE_GLASSES,
+    CASCADE_MODEL_COUNT
+};
+
+// 级联分类器注册表：每个模型的XML在进程内只解析一次
+// CascadeClassifier 不能被多个线程同时使用，所以按租借方式为每个调用者分配独立实例，用完归还复用
+class DetectorRegistry
+{
+public:
+    class Lease
+    {
+    public:
+        Lease() = default;
+        Lease(Lease &&other) noexcept;
+        Lease &operator=(Lease &&other) noexcept;
+        ~Lease();
+
+        CascadeClassifier *operator->() const { return classifier.get(); }
+        CascadeClassifier &operator*() const { return *classifier; }
+        explicit operator bool() const { return classifier != nullptr; }
+
+    private:
+        friend class DetectorRegistry;
+        void giveBack();
+
+        CascadeModel model = CASCADE_MODEL_COUNT;
+        unsigned generation = 0;
+        std::unique_ptr<CascadeClassifier> classifier;
+    };
+
+    static DetectorRegistry &instance();
+
+    void setModelDirectory(const std::string &dir);
+    std::string modelDirectory() const;
+    bool warmUp();  // 启动时预加载全部模型
+    Lease acquire(CascadeModel model);
+
+    static const char *fileName(CascadeModel model);
+
+private:
+    DetectorRegistry();
+    std::unique_ptr<CascadeClassifier> createLocked(CascadeModel model);
+    void release(Lease &lease);
+
+    struct Slot
+    {
+        FileStorage storage;  // 解析后的XML节点树，新实例直接从这里读取
+        std::vector<std::unique_ptr<CascadeClassifier>> idle;
+    };
+
+    mutable std::mutex mutex;
+    std::string modelDir;
+    unsigned generation = 0;
+    Slot slots[CASCADE_MODEL_COUNT];
+};
+
+#endif // DETECTORREGISTRY_H
@@ -0,0 +1,63 @@
+#include "displaycache.h"
+#include "traceprobe.h"
+
+// 金字塔最小层的长边
+static const int MIN_LEVEL_SIDE = 64;
+
+QImage DisplayCache::wrap(const Mat &image, ChannelOrder order)
+{
+    QImage::Format format = order == ORDER_GRAY ? QImage::Format_Grayscale8
+                          : order == ORDER_BGR  ? QImage::Format_BGR888
+                                                : QImage::Format_RGB888;
+    return QImage(image.data, image.cols, image.rows, static_cast<int>(image.step), format);
+}
+
+void DisplayCache::setImage(const Mat &image, ChannelOrder order)
+{
+    clear();
+    if (image.empty()) return;
+    TRACE_SCOPE("display.pyramid");
+
+    // BGR 像素由 QImage 按 Format_BGR888 读取，上传时的格式转换与 RGB888 相同，不再需要单独的整图转换
+    Mat level = image;
+    for (;;)
+    {
+        levels.push_back(QPixmap::fromImage(wrap(level, order)));  // fromImage 会复制数据，level 之后可以释放
+
+        if (std::max(level.cols, level.rows) / 2 < MIN_LEVEL_SIDE) break;
+        Mat half;
+        resize(level, half, Size((level.cols + 1) / 2, (level.rows + 1) / 2), 0, 0, INTER_AREA);
+        level = half;
+    }
+}
+
+void DisplayCache::clear()
+{
+    levels.clear();
+    smooth = QPixmap();
+    smoothTarget = QSize();
+}
+
+// 不小于目标尺寸的最小一层，缩小倍数不超过 2，插值质量接近从原图缩放
+const QPixmap &DisplayCache::levelFor(QSize fitted) const
+{
+    size_t i = 0;
+    while (i + 1 < levels.size() && levels[i + 1].width() >= fitted.width() && levels[i + 1].height() >= fitted.height())
+        i++;
+    return levels[i];
+}
+
+QPixmap DisplayCache::render(QSize target, bool fast)
+{
+    if (levels.empty() || target.isEmpty()) return QPixmap();
+    if (!fast && !smooth.isNull() && target == smoothTarget) return smooth;
+
+    TRACE_SCOPE(fast ? "display.scaleFast" : "display.scaleSmooth");
+    QSize fitted = levels[0].size().scaled(target, Qt::KeepAspectRatio);
+    const QPixmap &source = levelFor(fitted);
+    if (fast) return source.scaled(fitted, Qt::IgnoreAspectRatio, Qt::FastTransformation);
+
+    smooth = source.scaled(fitted, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+    smoothTarget = target;
+    return smooth;
+}
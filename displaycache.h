@@ -0,0 +1,37 @@
+#ifndef DISPLAYCACHE_H
+#define DISPLAYCACHE_H
+
+#include <QImage>
+#include <QPixmap>
+#include <QSize>
+#include <vector>
+#include "opencv2/opencv.hpp"
+#include "imageframe.h"
+
+using namespace cv;
+
+// 一幅显示图像的缓存：内容变化时生成一次 mip 金字塔（每层边长减半）并上传为 QPixmap，
+// 之后窗口缩放只从最接近目标尺寸的层缩放，不再从原始分辨率转换和缩放
+class DisplayCache
+{
+public:
+    void setImage(const Mat &image, ChannelOrder order);  // 图像内容变化时调用，image 为 CV_8UC3 或 CV_8UC1
+    void clear();
+    bool isEmpty() const { return levels.empty(); }
+
+    // 按原比例缩放到 target 以内。fast 为 true 时用最近邻插值（拖动窗口期间），
+    // 否则用平滑插值，结果按目标尺寸缓存，尺寸和内容不变时直接返回
+    QPixmap render(QSize target, bool fast);
+
+    // 按通道顺序选择 QImage 格式直接包装像素，不复制也不转换；显示和导出共用
+    static QImage wrap(const Mat &image, ChannelOrder order);
+
+private:
+    const QPixmap &levelFor(QSize fitted) const;
+
+    std::vector<QPixmap> levels;  // levels[0] 为原始分辨率
+    QPixmap smooth;
+    QSize smoothTarget;
+};
+
+#endif // DISPLAYCACHE_H
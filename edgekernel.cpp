@@ -0,0 +1,357 @@
+#include "edgekernel.h"
+#include "threadpool.h"
+#include "opencv2/core/hal/intrin.hpp"
+
+#if (CV_SIMD || CV_SIMD_SCALABLE)
+#define EDGE_SIMD 1
+#endif
+
+static const int GRAY_BLOCK = 8;  // 每次 cvtColor 转换的行数，灰度环形缓冲保留相邻两块
+static const int RING = 4;        // 其余各级环形缓冲的行数，大于滑动窗口的 3 行
+static const int CANNY_SHIFT = 15;
+static const int TG22 = static_cast<int>(0.4142135623730950488016887242097 * (1 << CANNY_SHIFT) + 0.5);
+
+// 3x3 Sobel 的纵向部分：c = r0 + 2*r1 + r2 供 x 方向使用，d = r2 - r0 供 y 方向使用。
+// c、d 下标 k 对应第 k-1 列，两端各留一个边界元素
+static void columnPass(const uchar *r0, const uchar *r1, const uchar *r2, short *c, short *d, int cols)
+{
+    int j = 0;
+#ifdef EDGE_SIMD
+    const int lanes = VTraits<v_int16>::vlanes();
+    for (; j <= cols - lanes; j += lanes)
+    {
+        v_int16 a0 = v_reinterpret_as_s16(vx_load_expand(r0 + j));
+        v_int16 a1 = v_reinterpret_as_s16(vx_load_expand(r1 + j));
+        v_int16 a2 = v_reinterpret_as_s16(vx_load_expand(r2 + j));
+        v_store(c + j + 1, v_add(v_add(a0, a2), v_add(a1, a1)));
+        v_store(d + j + 1, v_sub(a2, a0));
+    }
+#endif
+    for (; j < cols; j++)
+    {
+        c[j + 1] = static_cast<short>(r0[j] + 2 * r1[j] + r2[j]);
+        d[j + 1] = static_cast<short>(r2[j] - r0[j]);
+    }
+}
+
+// 填充左右边界：reflect101（Sobel 默认）或 replicate（Canny 内部）
+static void padColumns(short *c, short *d, int cols, bool reflect)
+{
+    int left = reflect && cols > 1 ? 2 : 1;
+    int right = reflect && cols > 1 ? cols - 1 : cols;
+    c[0] = c[left];
+    d[0] = d[left];
+    c[cols + 1] = c[right];
+    d[cols + 1] = d[right];
+}
+
+// convertScaleAbs 截断到 255，addWeighted(0.5, 0.5) 按四舍六入五成双取整
+static void magnitudeRow(const short *c, const short *d, uchar *out, int cols)
+{
+    int j = 0;
+#ifdef EDGE_SIMD
+    const int lanes = VTraits<v_int16>::vlanes();
+    const v_uint16 limit = vx_setall_u16(255), one = vx_setall_u16(1);
+    for (; j <= cols - lanes; j += lanes)
+    {
+        v_int16 gx = v_sub(vx_load(c + j + 2), vx_load(c + j));
+        v_int16 d1 = vx_load(d + j + 1);
+        v_int16 gy = v_add(v_add(vx_load(d + j), vx_load(d + j + 2)), v_add(d1, d1));
+        v_uint16 s = v_add(v_min(v_abs(gx), limit), v_min(v_abs(gy), limit));
+        v_pack_store(out + j, v_shr<1>(v_add(s, v_and(v_shr<1>(s), one))));
+    }
+#endif
+    for (; j < cols; j++)
+    {
+        int gx = c[j + 2] - c[j];
+        int gy = d[j] + 2 * d[j + 1] + d[j + 2];
+        int s = std::min(std::abs(gx), 255) + std::min(std::abs(gy), 255);
+        out[j] = static_cast<uchar>((s + ((s >> 1) & 1)) >> 1);
+    }
+}
+
+// Canny 的梯度与 L1 幅值
+static void gradientRow(const short *c, const short *d, short *dx, short *dy, int *mag, int cols)
+{
+    int j = 0;
+#ifdef EDGE_SIMD
+    const int lanes = VTraits<v_int16>::vlanes();
+    for (; j <= cols - lanes; j += lanes)
+    {
+        v_int16 gx = v_sub(vx_load(c + j + 2), vx_load(c + j));
+        v_int16 d1 = vx_load(d + j + 1);
+        v_int16 gy = v_add(v_add(vx_load(d + j), vx_load(d + j + 2)), v_add(d1, d1));
+        v_store(dx + j, gx);
+        v_store(dy + j, gy);
+        v_uint32 lo, hi;
+        v_expand(v_add(v_abs(gx), v_abs(gy)), lo, hi);
+        v_store(mag + j, v_reinterpret_as_s32(lo));
+        v_store(mag + j + lanes / 2, v_reinterpret_as_s32(hi));
+    }
+#endif
+    for (; j < cols; j++)
+    {
+        dx[j] = static_cast<short>(c[j + 2] - c[j]);
+        dy[j] = static_cast<short>(d[j] + 2 * d[j + 1] + d[j + 2]);
+        mag[j] = std::abs(dx[j]) + std::abs(dy[j]);
+    }
+}
+
+// 非极大值抑制，规则与 OpenCV Canny 相同。map：0 可能是边缘，1 不是边缘，2 是边缘
+static inline void suppressPixel(const int *magP, const int *magA, const int *magN, const short *dx, const short *dy,
+                                 uchar *map, int j, int high, std::vector<uchar *> &seeds)
+{
+    int m = magA[j];
+    int xs = dx[j], ys = dy[j];
+    int x = std::abs(xs);
+    int y = std::abs(ys) << CANNY_SHIFT;
+    int tg22x = x * TG22;
+
+    bool peak;
+    if (y < tg22x)
+    {
+        peak = m > magA[j - 1] && m >= magA[j + 1];
+    }
+    else
+    {
+        int tg67x = tg22x + (x << (CANNY_SHIFT + 1));
+        if (y > tg67x)
+        {
+            peak = m > magP[j] && m >= magN[j];
+        }
+        else
+        {
+            int s = (xs ^ ys) < 0 ? -1 : 1;
+            peak = m > magP[j - s] && m > magN[j + s];
+        }
+    }
+
+    if (!peak)
+    {
+        map[j] = 1;
+    }
+    else if (m > high)
+    {
+        map[j] = 2;
+        seeds.push_back(map + j);
+    }
+    else
+    {
+        map[j] = 0;
+    }
+}
+
+static void suppressRow(const int *magP, const int *magA, const int *magN, const short *dx, const short *dy,
+                        uchar *map, int cols, int low, int high, std::vector<uchar *> &seeds)
+{
+    int j = 0;
+#ifdef EDGE_SIMD
+    // 大部分像素的幅值不超过低阈值，整组跳过
+    const int lanes = VTraits<v_int32>::vlanes();
+    const v_int32 vlow = vx_setall_s32(low);
+    for (; j <= cols - lanes; j += lanes)
+    {
+        if (!v_check_any(v_gt(vx_load(magA + j), vlow)))
+        {
+            memset(map + j, 1, lanes);
+            continue;
+        }
+        for (int k = j; k < j + lanes; k++)
+        {
+            if (magA[k] > low) suppressPixel(magP, magA, magN, dx, dy, map, k, high, seeds);
+            else map[k] = 1;
+        }
+    }
+#endif
+    for (; j < cols; j++)
+    {
+        if (magA[j] > low) suppressPixel(magP, magA, magN, dx, dy, map, j, high, seeds);
+        else map[j] = 1;
+    }
+}
+
+// 从强边缘出发沿 8 邻域把相连的弱边缘标为边缘
+static void hysteresis(size_t mapstep, std::vector<uchar *> &stack)
+{
+    const ptrdiff_t offsets[8] = {
+        -static_cast<ptrdiff_t>(mapstep) - 1, -static_cast<ptrdiff_t>(mapstep), -static_cast<ptrdiff_t>(mapstep) + 1,
+        -1, 1,
+        static_cast<ptrdiff_t>(mapstep) - 1, static_cast<ptrdiff_t>(mapstep), static_cast<ptrdiff_t>(mapstep) + 1,
+    };
+    while (!stack.empty())
+    {
+        uchar *m = stack.back();
+        stack.pop_back();
+        for (ptrdiff_t offset : offsets)
+        {
+            if (!m[offset])
+            {
+                m[offset] = 2;
+                stack.push_back(m + offset);
+            }
+        }
+    }
+}
+
+namespace
+{
+// 一个条带内按行滚动的各级缓冲：灰度 → Sobel 幅值 → Canny 梯度。
+// 请求的行号在条带内单调递增，每级只保留最近几行，整条流水线的工作集留在缓存中
+class RowPipeline
+{
+public:
+    RowPipeline(const Mat &src, int grayCode)
+        : src(src)
+        , grayCode(grayCode)
+        , rows(src.rows)
+        , cols(src.cols)
+        , grayBuf(src.channels() == 1 ? 0 : 2 * GRAY_BLOCK, src.cols, CV_8UC1)
+        , edgeBuf(RING, src.cols, CV_8UC1)
+        , dxBuf(RING, src.cols, CV_16SC1)
+        , dyBuf(RING, src.cols, CV_16SC1)
+        , magBuf(RING, src.cols + 2, CV_32SC1)
+        , colSum(src.cols + 2)
+        , colDiff(src.cols + 2)
+        , zeroMag(src.cols + 2, 0)
+    {
+        std::fill(std::begin(edgeTag), std::end(edgeTag), -1);
+        std::fill(std::begin(gradTag), std::end(gradTag), -1);
+    }
+
+    const uchar *gray(int y)
+    {
+        // 输入已是灰度图时直接读取，不经过条带缓冲
+        if (src.channels() == 1) return src.ptr(y);
+
+        int block = y / GRAY_BLOCK, half = block & 1;
+        if (grayTag[half] != block)
+        {
+            // 灰度转换直接调用 cvtColor，保证与整图转换逐位一致
+            int y0 = block * GRAY_BLOCK, n = std::min(GRAY_BLOCK, rows - y0);
+            Mat dst = grayBuf.rowRange(half * GRAY_BLOCK, half * GRAY_BLOCK + n);
+            cvtColor(src.rowRange(y0, y0 + n), dst, grayCode);
+            grayTag[half] = block;
+        }
+        return grayBuf.ptr(half * GRAY_BLOCK + y % GRAY_BLOCK);
+    }
+
+    const uchar *edge(int y)
+    {
+        int slot = y % RING;
+        if (edgeTag[slot] != y)
+        {
+            const uchar *r0 = gray(borderInterpolate(y - 1, rows, BORDER_REFLECT_101));
+            const uchar *r1 = gray(y);
+            const uchar *r2 = gray(borderInterpolate(y + 1, rows, BORDER_REFLECT_101));
+            columnPass(r0, r1, r2, colSum.data(), colDiff.data(), cols);
+            padColumns(colSum.data(), colDiff.data(), cols, true);
+            magnitudeRow(colSum.data(), colDiff.data(), edgeBuf.ptr(slot), cols);
+            edgeTag[slot] = y;
+        }
+        return edgeBuf.ptr(slot);
+    }
+
+    // 图像外的行幅值为 0
+    const int *gradient(int y, const short *&dx, const short *&dy)
+    {
+        if (y < 0 || y >= rows)
+        {
+            dx = dy = nullptr;
+            return zeroMag.data() + 1;
+        }
+
+        int slot = y % RING;
+        int *mag = magBuf.ptr<int>(slot) + 1;
+        dx = dxBuf.ptr<short>(slot);
+        dy = dyBuf.ptr<short>(slot);
+        if (gradTag[slot] != y)
+        {
+            const uchar *e0 = edge(std::max(y - 1, 0));
+            const uchar *e1 = edge(y);
+            const uchar *e2 = edge(std::min(y + 1, rows - 1));
+            columnPass(e0, e1, e2, colSum.data(), colDiff.data(), cols);
+            padColumns(colSum.data(), colDiff.data(), cols, false);
+            gradientRow(colSum.data(), colDiff.data(), dxBuf.ptr<short>(slot), dyBuf.ptr<short>(slot), mag, cols);
+            mag[-1] = mag[cols] = 0;
+            gradTag[slot] = y;
+        }
+        return mag;
+    }
+
+private:
+    const Mat &src;
+    int grayCode;
+    int rows, cols;
+    Mat grayBuf, edgeBuf, dxBuf, dyBuf, magBuf;
+    int grayTag[2] = {-1, -1};
+    int edgeTag[RING];
+    int gradTag[RING];
+    std::vector<short> colSum, colDiff;
+    std::vector<int> zeroMag;
+};
+}
+
+// 条带数：每条至少 32 行，避免重复计算的边界行占比过高
+static int stripeCount(int rows, int threads)
+{
+    int wanted = threads > 0 ? threads : ThreadPool::shared().size() + 1;
+    return std::max(1, std::min(wanted, rows / 32));
+}
+
+void EdgeKernel::detect(const Mat &src, Mat &edges, double lowThresh, double highThresh, int threads, int grayCode)
+{
+    CV_Assert(src.type() == CV_8UC3 || src.type() == CV_8UC1);
+    if (lowThresh > highThresh) std::swap(lowThresh, highThresh);
+    int low = cvFloor(lowThresh), high = cvFloor(highThresh);
+    int rows = src.rows, cols = src.cols;
+
+    // 唯一的整图中间结果，四周各留一圈不是边缘的边界
+    Mat map(rows + 2, cols + 2, CV_8UC1);
+    memset(map.ptr(0), 1, map.cols);
+    memset(map.ptr(rows + 1), 1, map.cols);
+
+    int stripes = stripeCount(rows, threads);
+    std::vector<std::vector<uchar *>> seeds(stripes);
+    ThreadPool::shared().parallelFor(stripes, [&](int s) {
+        int y0 = rows * s / stripes, y1 = rows * (s + 1) / stripes;
+        RowPipeline pipeline(src, grayCode);
+        for (int y = y0; y < y1; y++)
+        {
+            const short *dx, *dy, *unusedX, *unusedY;
+            const int *magP = pipeline.gradient(y - 1, unusedX, unusedY);
+            const int *magA = pipeline.gradient(y, dx, dy);
+            const int *magN = pipeline.gradient(y + 1, unusedX, unusedY);
+
+            uchar *mapRow = map.ptr(y + 1) + 1;
+            mapRow[-1] = mapRow[cols] = 1;
+            suppressRow(magP, magA, magN, dx, dy, mapRow, cols, low, high, seeds[s]);
+        }
+    }, stripes);
+
+    std::vector<uchar *> stack;
+    for (std::vector<uchar *> &stripeSeeds : seeds) stack.insert(stack.end(), stripeSeeds.begin(), stripeSeeds.end());
+    hysteresis(map.step, stack);
+
+    edges.create(rows, cols, CV_8UC1);
+    ThreadPool::shared().parallelFor(stripes, [&](int s) {
+        for (int y = rows * s / stripes; y < rows * (s + 1) / stripes; y++)
+        {
+            const uchar *m = map.ptr(y + 1) + 1;
+            uchar *out = edges.ptr(y);
+            for (int j = 0; j < cols; j++) out[j] = static_cast<uchar>(-(m[j] >> 1));
+        }
+    }, stripes);
+}
+
+void EdgeKernel::sobelMagnitude(const Mat &src, Mat &magnitude, int grayCode)
+{
+    CV_Assert(src.type() == CV_8UC3 || src.type() == CV_8UC1);
+    magnitude.create(src.size(), CV_8UC1);
+
+    int stripes = stripeCount(src.rows, 0);
+    ThreadPool::shared().parallelFor(stripes, [&](int s) {
+        RowPipeline pipeline(src, grayCode);
+        for (int y = src.rows * s / stripes; y < src.rows * (s + 1) / stripes; y++)
+            memcpy(magnitude.ptr(y), pipeline.edge(y), src.cols);
+    }, stripes);
+}
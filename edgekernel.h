@@ -0,0 +1,23 @@
+#ifndef EDGEKERNEL_H
+#define EDGEKERNEL_H
+
+#include "opencv2/opencv.hpp"
+
+using namespace cv;
+
+// 融合的边缘检测：按行滚动完成灰度转换、3x3 Sobel 幅值和 Canny 梯度，
+// 只生成 Canny 的状态图这一幅整图中间结果，随后直接做非极大值抑制和滞后阈值。
+// 结果与 cvtColor(RGB2GRAY) → Sobel(CV_32F, 3) → convertScaleAbs → addWeighted(0.5, 0.5)
+// → Canny(low, high) 完全相同。src 为三通道时按 grayCode 逐条带转换（BGR 输入传 COLOR_BGR2GRAY），
+// 为单通道时直接作为灰度图读取
+class EdgeKernel
+{
+public:
+    static void detect(const Mat &src, Mat &edges, double lowThresh, double highThresh, int threads = 0,
+                       int grayCode = COLOR_RGB2GRAY);
+
+    // 单独的 Sobel 幅值部分，即 Canny 的输入
+    static void sobelMagnitude(const Mat &src, Mat &magnitude, int grayCode = COLOR_RGB2GRAY);
+};
+
+#endif // EDGEKERNEL_H
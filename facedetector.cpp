@@ -0,0 +1,97 @@
+#include "facedetector.h"
+#include "detectorregistry.h"
+#include "threadpool.h"
+#include <atomic>
+
+std::vector<Rect> FaceDetector::detectFaces(CascadeClassifier &detector, const Mat &gray, const FaceOptions &options)
+{
+    double scale = 1.0;
+    int longSide = std::max(gray.cols, gray.rows);
+    if (options.workingSize > 0 && longSide > options.workingSize)
+        scale = static_cast<double>(options.workingSize) / longSide;
+
+    // 缩小后再均衡化，直方图统计和级联扫描都只在工作分辨率上进行
+    Mat work;
+    if (scale < 1.0)
+        resize(gray, work, Size(), scale, scale, INTER_AREA);
+    else
+        work = gray;
+    Mat equalized;
+    equalizeHist(work, equalized);
+
+    // 最小人脸按比例缩小，但不小于级联分类器的检测窗口
+    Size window = detector.getOriginalWindowSize();
+    Size minSize(std::max(window.width, cvRound(options.minFace.width * scale)),
+                 std::max(window.height, cvRound(options.minFace.height * scale)));
+
+    std::vector<Rect> faces;
+    detector.detectMultiScale(equalized, faces, options.scaleFactor, options.minNeighbors,
+                              0 | CASCADE_SCALE_IMAGE, minSize);
+    if (scale == 1.0) return faces;
+
+    // 映射回原始分辨率
+    Rect bounds(0, 0, gray.cols, gray.rows);
+    for (Rect &face : faces)
+    {
+        Rect mapped(cvFloor(face.x / scale), cvFloor(face.y / scale),
+                    cvRound(face.width / scale), cvRound(face.height / scale));
+        face = mapped & bounds;
+    }
+    return faces;
+}
+
+std::vector<Rect> FaceDetector::detectEyes(CascadeClassifier &detector, const Mat &gray, Rect face,
+                                           const FaceOptions &options)
+{
+    face &= Rect(0, 0, gray.cols, gray.rows);
+    std::vector<Rect> eyes;
+    if (face.empty()) return eyes;
+
+    if (options.eyeFaceSize <= 0)
+    {
+        Mat faceROI;
+        equalizeHist(gray(face), faceROI);
+        detector.detectMultiScale(faceROI, eyes, 1.1, 2, 0 | CASCADE_SCALE_IMAGE, options.minEye);
+        for (Rect &eye : eyes) eye += face.tl();
+        return eyes;
+    }
+
+    // 人脸区域统一缩放后检测，大脸不再在大量无用的尺度上扫描
+    Mat faceROI;
+    resize(gray(face), faceROI, Size(options.eyeFaceSize, options.eyeFaceSize), 0, 0,
+           face.width > options.eyeFaceSize ? INTER_AREA : INTER_LINEAR);
+    equalizeHist(faceROI, faceROI);
+    detector.detectMultiScale(faceROI, eyes, 1.1, 2, 0 | CASCADE_SCALE_IMAGE, options.minEye);
+
+    double sx = static_cast<double>(face.width) / options.eyeFaceSize;
+    double sy = static_cast<double>(face.height) / options.eyeFaceSize;
+    for (Rect &eye : eyes)
+    {
+        eye = Rect(face.x + cvRound(eye.x * sx), face.y + cvRound(eye.y * sy),
+                   cvRound(eye.width * sx), cvRound(eye.height * sy));
+    }
+    return eyes;
+}
+
+bool FaceDetector::detectEyesParallel(const Mat &gray, std::vector<FaceResult> &faces, const FaceOptions &options,
+                                      bool *abortedOut)
+{
+    std::atomic<bool> loaded{true}, aborted{false};
+    std::atomic<int> finished{0};
+    int count = static_cast<int>(faces.size());
+    ThreadPool::shared().parallelFor(count, [&](int i) {
+        if (aborted) return;
+        // 同时运行的任务各持有一个实例，空闲实例由注册表回收复用，实例数不超过线程数
+        DetectorRegistry::Lease detector = DetectorRegistry::instance().acquire(CASCADE_EYE_GLASSES);
+        if (!detector)
+        {
+            loaded = false;
+            return;
+        }
+        faces[i].eyes = detectEyes(*detector, gray, faces[i].face, options);
+        // 人脸检测完成时已报告一半
+        if (options.progress && !options.progress(0.5 + 0.5 * ++finished / count)) aborted = true;
+    }, options.threads);
+    if (abortedOut) *abortedOut = aborted;
+    return loaded;
+}
@@ -0,0 +1,45 @@
+#ifndef FACEDETECTOR_H
+#define FACEDETECTOR_H
+
+#include "opencv2/opencv.hpp"
+#include "cvfunction.h"
+
+using namespace cv;
+
+struct FaceOptions
+{
+    int workingSize = 0;        // 人脸检测时图像长边缩放到的像素数，0 表示在原始分辨率上检测
+    double scaleFactor = 1.1;
+    int minNeighbors = 2;
+    Size minFace = Size(30, 30);  // 原始分辨率下的最小人脸
+    int eyeFaceSize = 128;        // 检测眼睛前人脸区域统一缩放到的边长，0 表示直接在原始人脸区域上检测
+    Size minEye = Size(20, 20);   // 缩放后人脸区域中的最小眼睛
+    int threads = 0;              // 并行检测眼睛的线程数，0 表示使用全部核心
+    ProgressCallback progress;    // 非空时在人脸检测后、逐个人脸检测眼睛时报告进度，返回 false 时中止
+};
+
+struct FaceResult
+{
+    Rect face;
+    Mat crop;                // 原图中的人脸区域（视图）
+    std::vector<Rect> eyes;  // 原始分辨率坐标
+};
+
+// 人脸和眼睛检测，输入为未均衡化的单通道灰度图，返回的矩形均为原始分辨率坐标
+class FaceDetector
+{
+public:
+    // 在缩小后的副本上检测人脸，再把人脸框映射回原始分辨率
+    static std::vector<Rect> detectFaces(CascadeClassifier &detector, const Mat &gray, const FaceOptions &options);
+
+    // 从原始分辨率灰度图中裁出人脸、缩放到统一尺寸后检测眼睛
+    static std::vector<Rect> detectEyes(CascadeClassifier &detector, const Mat &gray, Rect face,
+                                        const FaceOptions &options);
+
+    // 多个人脸的眼睛并行检测。级联分类器不是线程安全的，每个任务从注册表租借各自的实例。
+    // 返回 false 表示眼睛检测器加载失败；进度回调要求中止后其余人脸不再检测，aborted 非空时置为 true
+    static bool detectEyesParallel(const Mat &gray, std::vector<FaceResult> &faces, const FaceOptions &options,
+                                   bool *aborted = nullptr);
+};
+
+#endif // FACEDETECTOR_H
@@ -0,0 +1,95 @@
+#include "facestream.h"
+
+FaceStreamDetector::FaceStreamDetector(const FaceStreamOptions &options)
+    : opts(options)
+{
+}
+
+FaceStreamDetector::~FaceStreamDetector() {}
+
+void FaceStreamDetector::reset()
+{
+    tracks.clear();
+    framesSinceScan = 0;
+}
+
+std::vector<Rect> FaceStreamDetector::detect(CascadeClassifier &detector, const Mat &gray, bool *fullScan)
+{
+    bool full = tracks.empty() || framesSinceScan >= opts.fullScanInterval;
+
+    std::vector<Rect> faces;
+    if (!full)
+    {
+        for (const Rect &track : tracks)
+        {
+            Rect found;
+            if (!scanAround(detector, gray, track, found))
+            {
+                // 有人脸丢失时当帧改做整帧扫描，同时找回新出现的人脸
+                full = true;
+                break;
+            }
+
+            // 相邻人脸的扩展区域可能重叠，同一张脸只保留一次
+            bool duplicate = false;
+            for (const Rect &face : faces)
+                duplicate |= (face & found).area() * 2 > std::min(face.area(), found.area());
+            if (!duplicate) faces.push_back(found);
+        }
+    }
+
+    if (full)
+    {
+        faces = scanFull(detector, gray);
+        framesSinceScan = 0;
+    }
+    else
+    {
+        framesSinceScan++;
+    }
+
+    tracks = faces;
+    if (fullScan) *fullScan = full;
+    return faces;
+}
+
+std::vector<Rect> FaceStreamDetector::scanFull(CascadeClassifier &detector, const Mat &gray)
+{
+    return FaceDetector::detectFaces(detector, gray, opts.face);
+}
+
+bool FaceStreamDetector::scanAround(CascadeClassifier &detector, const Mat &gray, const Rect &track, Rect &found)
+{
+    int dx = cvRound(track.width * opts.roiMargin);
+    int dy = cvRound(track.height * opts.roiMargin);
+    Rect roi = Rect(track.x - dx, track.y - dy, track.width + 2 * dx, track.height + 2 * dy) & Rect(0, 0, gray.cols, gray.rows);
+    if (roi.empty()) return false;
+
+    // 局部区域使用与整帧扫描相同的缩放比例，只搜索与上一帧人脸接近的尺度
+    FaceOptions local = opts.face;
+    int longSide = std::max(gray.cols, gray.rows);
+    if (local.workingSize > 0 && longSide > local.workingSize)
+        local.workingSize = std::max(1, cvRound(std::max(roi.width, roi.height) * local.workingSize / static_cast<double>(longSide)));
+    else
+        local.workingSize = 0;
+    local.minFace = Size(cvRound(track.width * opts.minScale), cvRound(track.height * opts.minScale));
+
+    std::vector<Rect> faces = FaceDetector::detectFaces(detector, gray(roi), local);
+    if (faces.empty()) return false;
+
+    // 取与上一帧位置重叠最多的一个
+    Rect best;
+    int bestOverlap = -1;
+    for (Rect face : faces)
+    {
+        face += roi.tl();
+        int overlap = (face & track).area();
+        if (overlap > bestOverlap)
+        {
+            bestOverlap = overlap;
+            best = face;
+        }
+    }
+    found = best;
+    return true;
+}
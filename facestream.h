@@ -0,0 +1,40 @@
+#ifndef FACESTREAM_H
+#define FACESTREAM_H
+
+#include "opencv2/opencv.hpp"
+#include "facedetector.h"
+
+using namespace cv;
+
+struct FaceStreamOptions
+{
+    FaceOptions face;           // 整帧扫描使用的检测参数
+    int fullScanInterval = 15;  // 每隔多少帧做一次整帧扫描
+    double roiMargin = 0.5;     // 局部检测区域在人脸框四周各扩展的比例（相对人脸边长）
+    double minScale = 0.7;      // 局部检测的最小人脸相对上一帧人脸的比例
+};
+
+// 视频流人脸检测：两次整帧扫描之间只在上一帧人脸周围的扩展区域内运行级联分类器，
+// 每隔 fullScanInterval 帧或有人脸丢失时重新整帧扫描
+class FaceStreamDetector
+{
+public:
+    explicit FaceStreamDetector(const FaceStreamOptions &options = FaceStreamOptions());
+    ~FaceStreamDetector();
+
+    // gray 为未均衡化的灰度帧；fullScan 返回本帧是否做了整帧扫描
+    std::vector<Rect> detect(CascadeClassifier &detector, const Mat &gray, bool *fullScan = nullptr);
+    void reset();
+
+    const FaceStreamOptions &options() const { return opts; }
+
+private:
+    std::vector<Rect> scanFull(CascadeClassifier &detector, const Mat &gray);
+    bool scanAround(CascadeClassifier &detector, const Mat &gray, const Rect &track, Rect &found);
+
+    FaceStreamOptions opts;
+    std::vector<Rect> tracks;  // 上一帧的人脸
+    int framesSinceScan = 0;
+};
+
+#endif // FACESTREAM_H
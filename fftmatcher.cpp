@@ -0,0 +1,71 @@
+#include "fftmatcher.h"
+
+FftMatcher::FftMatcher() {}
+
+FftMatcher::FftMatcher(const PreparedTemplate &ref, Size srcSize)
+{
+    reset(ref, srcSize);
+}
+
+FftMatcher::~FftMatcher() {}
+
+void FftMatcher::reset(const PreparedTemplate &templ, Size size)
+{
+    CV_Assert(!templ.empty());
+    CV_Assert(size.width >= templ.size().width && size.height >= templ.size().height);
+
+    ref = &templ;
+    srcSize = size;
+    Size dft = PreparedTemplate::dftSizeFor(srcSize);
+    Size resultSize(srcSize.width - templ.size().width + 1, srcSize.height - templ.size().height + 1);
+
+    refSpectrum = templ.spectrum(dft);
+    ws.padded = Mat::zeros(dft, CV_32F);
+    ws.spectrum.create(dft, CV_32F);
+    ws.corr.create(dft, CV_32F);
+    ws.sum.create(srcSize.height + 1, srcSize.width + 1, CV_64F);
+    ws.sqsum.create(srcSize.height + 1, srcSize.width + 1, CV_64F);
+    gray.create(srcSize, CV_8UC1);
+    srcArea = ws.padded(Rect(Point(0, 0), srcSize));
+    scores = ws.corr(Rect(Point(0, 0), resultSize));
+
+    // 与 cv::dft 内部相同的 HAL 调用，只是计划只创建一次：
+    // 正变换只有前 srcSize.height 行非零，逆变换只需要前 resultSize.height 行的实数输出
+    forward = hal::DFT2D::create(dft.width, dft.height, CV_32F, 1, 1, CV_HAL_DFT_IS_CONTINUOUS, srcSize.height);
+    inverse = hal::DFT2D::create(dft.width, dft.height, CV_32F, 1, 1,
+                                 CV_HAL_DFT_INVERSE | CV_HAL_DFT_SCALE | CV_HAL_DFT_IS_CONTINUOUS, resultSize.height);
+}
+
+void FftMatcher::resize(Size size)
+{
+    CV_Assert(!empty());
+    reset(*ref, size);
+}
+
+const Mat &FftMatcher::match(const Mat &src, Method METHOD)
+{
+    CV_Assert(!empty() && src.size() == srcSize);
+    CV_Assert(src.type() == CV_8UC3 || src.type() == CV_8UC1);
+
+    const Mat *srcGray = &src;
+    if (src.channels() == 3)
+    {
+        cvtColor(src, gray, COLOR_RGB2GRAY);
+        srcGray = &gray;
+    }
+
+    // 互相关 = IDFT(F(src) * conj(F(ref)))；各缓冲尺寸不变，转换和变换都写入已有内存
+    srcGray->convertTo(srcArea, CV_32F);
+    forward->apply(ws.padded.data, ws.padded.step, ws.spectrum.data, ws.spectrum.step);
+    mulSpectrums(ws.spectrum, refSpectrum, ws.spectrum, 0, true);
+    inverse->apply(ws.spectrum.data, ws.spectrum.step, ws.corr.data, ws.corr.step);
+
+    if (METHOD == Method::TM_CCORR) return scores;
+
+    if (METHOD == Method::TM_CCOEFF)
+        integral(*srcGray, ws.sum, CV_64F);
+    else
+        integral(*srcGray, ws.sum, ws.sqsum, CV_64F, CV_64F);
+    ref->normalizeScores(scores, METHOD, ws.sum, ws.sqsum);
+    return scores;
+}
@@ -0,0 +1,42 @@
+#ifndef FFTMATCHER_H
+#define FFTMATCHER_H
+
+#include "opencv2/opencv.hpp"
+#include "opencv2/core/hal/hal.hpp"
+#include "preparedtemplate.h"
+
+using namespace cv;
+
+// 固定（源图尺寸，模板）的频域匹配器：DFT 计划、模板频谱和全部中间缓冲在 reset() 时准备好，
+// 之后每张同尺寸的源图只做一次正变换、一次频谱相乘和一次逆变换，不再分配内存。
+// 实例不能在多个线程间共享，多线程批处理时每个线程各持一个；模板须在匹配器之前一直有效
+class FftMatcher
+{
+public:
+    FftMatcher();
+    FftMatcher(const PreparedTemplate &ref, Size srcSize);
+    ~FftMatcher();
+
+    void reset(const PreparedTemplate &ref, Size srcSize);
+    void resize(Size srcSize);  // 换一个源图尺寸，模板不变
+    bool empty() const { return ref == nullptr; }
+    Size sourceSize() const { return srcSize; }
+    Size templateSize() const { return ref ? ref->size() : Size(); }
+    Size dftSize() const { return ws.padded.size(); }
+
+    // src 为 RGB 或单通道图像，尺寸须等于 sourceSize()。
+    // 返回的得分图与 matchTemplate(srcGray, ref.gray(), result, METHOD) 一致，引用内部缓冲，下次调用前有效
+    const Mat &match(const Mat &src, Method METHOD);
+
+private:
+    const PreparedTemplate *ref = nullptr;
+    Size srcSize;
+    Mat refSpectrum;
+    MatchWorkspace ws;
+    Mat gray;      // RGB 输入转换后的灰度图
+    Mat srcArea;   // ws.padded 中源图所在区域，补零部分只在 reset() 时清零一次
+    Mat scores;    // ws.corr 中有效的得分区域
+    Ptr<hal::DFT2D> forward, inverse;
+};
+
+#endif // FFTMATCHER_H
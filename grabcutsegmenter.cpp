@@ -0,0 +1,127 @@
+#include "grabcutsegmenter.h"
+#include "threadpool.h"
+#include "traceprobe.h"
+#include <atomic>
+
+// 图像中心去掉四周 margin 的矩形
+static Rect innerRect(Size size, int margin)
+{
+    return Rect(margin, margin, size.width - 2 * margin, size.height - 2 * margin);
+}
+
+// 以 GC_INIT_WITH_RECT 迭代 options.iterations 次，进度从 from 报告到 to
+bool GrabCutSegmenter::iterate(const Mat &img, Mat &mask, Rect rect, Mat &bgModel, Mat &fgModel,
+                               const GrabCutOptions &options, double from, double to)
+{
+    TRACE_SCOPE("grabcut.iterate");
+    if (!options.progress)
+    {
+        grabCut(img, mask, rect, bgModel, fgModel, options.iterations, GC_INIT_WITH_RECT);
+        return true;
+    }
+
+    // 逐次调用：第一次初始化模型，之后 GC_EVAL 从保存的模型继续，与一次调用多次迭代的结果相同
+    for (int i = 0; i < options.iterations; i++)
+    {
+        grabCut(img, mask, rect, bgModel, fgModel, 1, i == 0 ? GC_INIT_WITH_RECT : GC_EVAL);
+        if (!options.progress(from + (to - from) * (i + 1) / options.iterations)) return false;
+    }
+    return true;
+}
+
+bool GrabCutSegmenter::segment(const Mat &src, Mat &mask, const GrabCutOptions &options, Mat *bgOut, Mat *fgOut)
+{
+    Rect rect = innerRect(src.size(), options.margin);
+    Mat bgModel, fgModel;
+
+    if (options.scale >= 1.0)
+    {
+        mask.create(src.size(), CV_8UC1);
+        mask.setTo(Scalar(GC_BGD));
+        mask(rect).setTo(Scalar(GC_PR_FGD));
+        if (!iterate(src, mask, rect, bgModel, fgModel, options, 0.0, 1.0)) return false;
+        if (bgOut) *bgOut = bgModel;
+        if (fgOut) *fgOut = fgModel;
+        return true;
+    }
+
+    // 在缩小的图像上完成全部迭代，颜色模型与分辨率无关，可直接用于原始分辨率
+    TRACE_STAGE(stage, "grabcut.downscale");
+    Mat small;
+    resize(src, small, Size(), options.scale, options.scale, INTER_AREA);
+    Mat smallMask(small.size(), CV_8UC1, Scalar(GC_BGD));
+    Rect smallRect = innerRect(small.size(), std::max(1, cvRound(options.margin * options.scale)));
+    // 进度按粗分割和细化各占一半估算
+    TRACE_END(stage);
+    if (!iterate(small, smallMask, smallRect, bgModel, fgModel, options, 0.0, 0.5)) return false;
+
+    // 前景掩码放大到原始分辨率
+    TRACE_NEXT(stage, "grabcut.band");
+    Mat coarse = (smallMask & 1) * 255, foreground;
+    resize(coarse, foreground, src.size(), 0, 0, INTER_LINEAR);
+    foreground = foreground >= 128;
+
+    // 边界两侧 bandWidth 以内的像素标为“可能”，需要重新分割；带外沿用粗分割结果并固定
+    int kernel = 2 * std::max(1, options.bandWidth) + 1;
+    Mat element = getStructuringElement(MORPH_ELLIPSE, Size(kernel, kernel));
+    Mat dilated, eroded;
+    dilate(foreground, dilated, element);
+    erode(foreground, eroded, element);
+    Mat band = dilated != eroded;
+
+    Mat seeded(src.size(), CV_8UC1, Scalar(GC_BGD));
+    seeded.setTo(Scalar(GC_FGD), foreground);
+    seeded.setTo(Scalar(GC_PR_BGD), band & ~foreground);
+    seeded.setTo(Scalar(GC_PR_FGD), band & foreground);
+
+    // 初始矩形之外始终是背景，与原始分辨率 GC_INIT_WITH_RECT 的约束一致
+    Mat outside(src.size(), CV_8UC1, Scalar(255));
+    outside(rect).setTo(Scalar(0));
+    seeded.setTo(Scalar(GC_BGD), outside);
+    band &= ~outside;
+    TRACE_END(stage);
+
+    if (!refineBand(src, seeded, band, mask, bgModel, fgModel, options, 0.5)) return false;
+    if (bgOut) *bgOut = bgModel;
+    if (fgOut) *fgOut = fgModel;
+    return true;
+}
+
+bool GrabCutSegmenter::refineBand(const Mat &src, const Mat &seeded, const Mat &band, Mat &mask, const Mat &bgModel,
+                                  const Mat &fgModel, const GrabCutOptions &options, double from)
+{
+    TRACE_SCOPE("grabcut.refine");
+    seeded.copyTo(mask);
+
+    // 只处理含有窄带像素的分块
+    int tileSize = std::max(32, options.tileSize);
+    std::vector<Rect> tiles;
+    for (int y = 0; y < src.rows; y += tileSize)
+    {
+        for (int x = 0; x < src.cols; x += tileSize)
+        {
+            Rect tile = Rect(x, y, tileSize, tileSize) & Rect(0, 0, src.cols, src.rows);
+            if (countNonZero(band(tile)) > 0) tiles.push_back(tile);
+        }
+    }
+
+    // 每块向外扩展 bandWidth 作为图割的上下文，只写回块本身；读取 seeded、写入 mask，块之间互不影响。
+    // GC_EVAL_FREEZE_MODEL 不再更新颜色模型，一次图割即为最终结果
+    int pad = std::max(1, options.bandWidth);
+    Rect bounds(0, 0, src.cols, src.rows);
+    std::atomic<int> finished{0};
+    std::atomic<bool> aborted{false};
+    ThreadPool::shared().parallelFor(static_cast<int>(tiles.size()), [&](int i) {
+        if (aborted) return;
+        TRACE_SCOPE("grabcut.tile");
+        Rect tile = tiles[i];
+        Rect context = Rect(tile.x - pad, tile.y - pad, tile.width + 2 * pad, tile.height + 2 * pad) & bounds;
+        Mat tileMask = seeded(context).clone();
+        Mat bg = bgModel.clone(), fg = fgModel.clone();
+        grabCut(src(context), tileMask, Rect(), bg, fg, 1, GC_EVAL_FREEZE_MODEL);
+        tileMask(tile - context.tl()).copyTo(mask(tile));
+        if (options.progress && !options.progress(from + (1.0 - from) * ++finished / tiles.size()))
+            aborted = true;
+    }, options.threads);
+    return !aborted;
+}
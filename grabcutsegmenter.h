@@ -0,0 +1,38 @@
+#ifndef GRABCUTSEGMENTER_H
+#define GRABCUTSEGMENTER_H
+
+#include "opencv2/opencv.hpp"
+#include "cvfunction.h"
+
+using namespace cv;
+
+struct GrabCutOptions
+{
+    double scale = 1.0;   // 粗分割时图像的缩放比例，1 表示直接在原始分辨率上分割
+    int bandWidth = 8;    // 原始分辨率下沿粗分割边界重新分割的带宽（单侧像素数）
+    int iterations = 5;   // 粗分割的迭代次数
+    int margin = 20;      // 初始矩形到图像边缘的距离（原始分辨率）
+    int tileSize = 256;   // 细化时的分块边长，各块并行分割
+    int threads = 0;      // 细化的线程数，0 表示使用全部核心
+    ProgressCallback progress;  // 非空时逐次迭代、逐块细化并报告进度，可能在其它线程中调用
+};
+
+// GrabCut 前景分割。scale < 1 时先在缩小的图像上分割，掩码放大后只在边界附近的窄带内
+// 用粗分割得到的颜色模型在原始分辨率上重新做图割，其余像素直接沿用粗分割结果
+class GrabCutSegmenter
+{
+public:
+    // mask 输出为原始分辨率的 GC_BGD/GC_FGD/GC_PR_BGD/GC_PR_FGD 标签；
+    // bgModel/fgModel 非空时输出拟合得到的颜色模型，可用于后续 GC_EVAL 继续迭代。
+    // 进度回调要求中止时返回 false，此时 mask 为未完成的结果
+    static bool segment(const Mat &src, Mat &mask, const GrabCutOptions &options, Mat *bgModel = nullptr,
+                        Mat *fgModel = nullptr);
+
+private:
+    static bool iterate(const Mat &img, Mat &mask, Rect rect, Mat &bgModel, Mat &fgModel,
+                        const GrabCutOptions &options, double from, double to);
+    static bool refineBand(const Mat &src, const Mat &seeded, const Mat &band, Mat &mask, const Mat &bgModel,
+                           const Mat &fgModel, const GrabCutOptions &options, double from);
+};
+
+#endif // GRABCUTSEGMENTER_H
@@ -0,0 +1,39 @@
+#include "grabcutsession.h"
+#include "traceprobe.h"
+
+GrabCutSession::GrabCutSession(const GrabCutOptions &options) : options(options) {}
+
+void GrabCutSession::reset()
+{
+    mask.release();
+    bgModel.release();
+    fgModel.release();
+    iterations = 0;
+}
+
+int GrabCutSession::run(const Mat &src, int count)
+{
+    if (!isActive())
+    {
+        bool done = GrabCutSegmenter::segment(src, mask, options, &bgModel, &fgModel);
+        options.progress = nullptr;  // 回调只用于首次完整分割，不再保留
+        if (!done)
+        {
+            reset();
+            return 0;
+        }
+        iterations = options.iterations;
+        return options.iterations;
+    }
+
+    if (mask.size() != src.size())
+        resize(mask, mask, src.size(), 0, 0, INTER_NEAREST);
+
+    // GC_INIT_WITH_MASK 会用 kmeans 重新初始化模型；GC_EVAL 从保留的模型出发，每次只做一轮
+    // 分配、学习和图割，确定背景/前景的像素保持不变
+    count = std::max(1, count);
+    TRACE_SCOPE("grabcut.continue");
+    grabCut(src, mask, Rect(), bgModel, fgModel, count, GC_EVAL);
+    iterations += count;
+    return count;
+}
@@ -0,0 +1,38 @@
+#ifndef GRABCUTSESSION_H
+#define GRABCUTSESSION_H
+
+#include "opencv2/opencv.hpp"
+#include "grabcutsegmenter.h"
+
+using namespace cv;
+
+// 跨调用保留 GrabCut 掩码和颜色模型的会话。首次调用按 options 完整分割；
+// 之后在保留的掩码和模型上用 GC_EVAL 继续迭代，既可在同一图像上追加迭代，
+// 也可在同一场景的新图像（编辑后的图像、序列的下一帧）上热启动
+class GrabCutSession
+{
+public:
+    explicit GrabCutSession(const GrabCutOptions &options = GrabCutOptions());
+
+    void setOptions(const GrabCutOptions &options) { this->options = options; }
+    const GrabCutOptions &getOptions() const { return options; }
+
+    bool isActive() const { return !mask.empty(); }
+    void reset();
+
+    // 未开始时完整分割并返回 options.iterations（被进度回调中止时返回 0，会话保持未开始）；
+    // 否则在 src 上继续 iterations 次迭代并返回该次数。
+    // src 与上次尺寸不同时掩码按最近邻缩放，颜色模型与分辨率无关，直接沿用
+    int run(const Mat &src, int iterations = 1);
+
+    const Mat &labels() const { return mask; }  // GC_BGD/GC_FGD/GC_PR_BGD/GC_PR_FGD
+    int totalIterations() const { return iterations; }
+
+private:
+    GrabCutOptions options;
+    Mat mask;
+    Mat bgModel, fgModel;
+    int iterations = 0;
+};
+
+#endif // GRABCUTSESSION_H
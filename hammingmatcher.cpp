@@ -0,0 +1,226 @@
+#include "hammingmatcher.h"
+#include "threadpool.h"
+#include <climits>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define HAMMING_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define HAMMING_TARGET(isa)
+#else
+#define HAMMING_TARGET(isa) __attribute__((target(isa)))
+#endif
+#endif
+
+// 缓存分块大小：一个 train 块（256 x 32 字节）和一个 query 块常驻 L1
+static const int TRAIN_BLOCK = 256;
+static const int QUERY_BLOCK = 64;
+static const int DESC_BYTES = 32;  // ORB 描述符长度，其它长度走通用路径
+
+typedef void (*DistanceKernel)(const uchar *query, const uchar *train, int count, int *dist);
+
+static inline int popcount64(uint64_t x)
+{
+    x = x - ((x >> 1) & 0x5555555555555555ULL);
+    x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+    x = (x + (x >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+    return static_cast<int>((x * 0x0101010101010101ULL) >> 56);
+}
+
+// 一个 query 对 count 个连续存放的 32 字节 train 描述符
+static void distanceScalar(const uchar *query, const uchar *train, int count, int *dist)
+{
+    uint64_t q[4];
+    std::memcpy(q, query, DESC_BYTES);
+    for (int j = 0; j < count; j++, train += DESC_BYTES)
+    {
+        uint64_t t[4];
+        std::memcpy(t, train, DESC_BYTES);
+        dist[j] = popcount64(q[0] ^ t[0]) + popcount64(q[1] ^ t[1]) + popcount64(q[2] ^ t[2]) + popcount64(q[3] ^ t[3]);
+    }
+}
+
+#ifdef HAMMING_X86
+// AVX2 没有向量 popcount，用半字节查表 + SAD 求和
+HAMMING_TARGET("avx2")
+static void distanceAvx2(const uchar *query, const uchar *train, int count, int *dist)
+{
+    const __m256i lut = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                         0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i lowMask = _mm256_set1_epi8(0x0f);
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i q = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(query));
+
+    for (int j = 0; j < count; j++, train += DESC_BYTES)
+    {
+        __m256i x = _mm256_xor_si256(q, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(train)));
+        __m256i lo = _mm256_and_si256(x, lowMask);
+        __m256i hi = _mm256_and_si256(_mm256_srli_epi16(x, 4), lowMask);
+        __m256i cnt = _mm256_add_epi8(_mm256_shuffle_epi8(lut, lo), _mm256_shuffle_epi8(lut, hi));
+        __m256i sad = _mm256_sad_epu8(cnt, zero);
+        __m128i s = _mm_add_epi64(_mm256_castsi256_si128(sad), _mm256_extracti128_si256(sad, 1));
+        dist[j] = _mm_cvtsi128_si32(s) + _mm_extract_epi32(s, 2);
+    }
+}
+
+// AVX-512 VPOPCNTDQ：一条 512 位指令同时处理两个 train 描述符
+HAMMING_TARGET("avx512f,avx512vpopcntdq")
+static void distanceAvx512(const uchar *query, const uchar *train, int count, int *dist)
+{
+    const __m512i q = _mm512_broadcast_i64x4(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(query)));
+
+    int j = 0;
+    for (; j + 1 < count; j += 2, train += 2 * DESC_BYTES)
+    {
+        __m512i x = _mm512_xor_si512(q, _mm512_loadu_si512(train));
+        __m512i cnt = _mm512_popcnt_epi64(x);
+        dist[j] = static_cast<int>(_mm512_mask_reduce_add_epi64(0x0F, cnt));
+        dist[j + 1] = static_cast<int>(_mm512_mask_reduce_add_epi64(0xF0, cnt));
+    }
+    if (j < count)
+    {
+        __m512i t = _mm512_castsi256_si512(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(train)));
+        __m512i cnt = _mm512_popcnt_epi64(_mm512_xor_si512(q, t));
+        dist[j] = static_cast<int>(_mm512_mask_reduce_add_epi64(0x0F, cnt));
+    }
+}
+#endif
+
+static DistanceKernel kernelFor(HammingMatcher::Isa isa)
+{
+#ifdef HAMMING_X86
+    if (isa == HammingMatcher::ISA_AVX512) return distanceAvx512;
+    if (isa == HammingMatcher::ISA_AVX2) return distanceAvx2;
+#endif
+    (void)isa;
+    return distanceScalar;
+}
+
+HammingMatcher::HammingMatcher(int threads)
+    : threads(threads)
+    , kernelIsa(detectIsa())
+{
+}
+
+HammingMatcher::~HammingMatcher() {}
+
+HammingMatcher::Isa HammingMatcher::detectIsa()
+{
+#if defined(HAMMING_X86) && defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) return ISA_SCALAR;
+    __cpuid(info, 1);
+    bool osxsave = (info[2] >> 27) & 1;
+    if (!osxsave) return ISA_SCALAR;
+    unsigned long long xcr0 = _xgetbv(0);
+    __cpuidex(info, 7, 0);
+    bool avx2 = ((info[1] >> 5) & 1) && (xcr0 & 0x6) == 0x6;
+    bool avx512 = ((info[1] >> 16) & 1) && ((info[2] >> 14) & 1) && (xcr0 & 0xe6) == 0xe6;
+    if (avx512) return ISA_AVX512;
+    if (avx2) return ISA_AVX2;
+#elif defined(HAMMING_X86)
+    // GCC/Clang 的检测已包含操作系统是否保存扩展寄存器
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512vpopcntdq")) return ISA_AVX512;
+    if (__builtin_cpu_supports("avx2")) return ISA_AVX2;
+#endif
+    return ISA_SCALAR;
+}
+
+const char *HammingMatcher::isaName(Isa isa)
+{
+    switch (isa)
+    {
+    case ISA_AVX512: return "avx512";
+    case ISA_AVX2:   return "avx2";
+    default:         return "scalar";
+    }
+}
+
+void HammingMatcher::setIsa(Isa isa)
+{
+    kernelIsa = std::min(isa, detectIsa());
+}
+
+// 对每个 train 描述符找出距离最近的 query（距离相同时取序号最小者）
+void HammingMatcher::nearestQueries(const Mat &query, const Mat &train, std::vector<int> &bestQuery,
+                                    std::vector<int> &bestDist) const
+{
+    int trainRows = train.rows, queryRows = query.rows;
+    bestQuery.assign(trainRows, -1);
+    bestDist.assign(trainRows, INT_MAX);
+
+    bool fixedWidth = query.cols == DESC_BYTES && train.isContinuous();
+    DistanceKernel kernel = kernelFor(kernelIsa);
+
+    int blocks = (trainRows + TRAIN_BLOCK - 1) / TRAIN_BLOCK;
+    auto body = [&](int block) {
+        int t0 = block * TRAIN_BLOCK;
+        int t1 = std::min(trainRows, t0 + TRAIN_BLOCK);
+        int dist[TRAIN_BLOCK];
+
+        for (int q0 = 0; q0 < queryRows; q0 += QUERY_BLOCK)
+        {
+            int q1 = std::min(queryRows, q0 + QUERY_BLOCK);
+            for (int i = q0; i < q1; i++)
+            {
+                const uchar *qd = query.ptr(i);
+                if (fixedWidth)
+                {
+                    kernel(qd, train.ptr(t0), t1 - t0, dist);
+                }
+                else
+                {
+                    for (int j = t0; j < t1; j++)
+                        dist[j - t0] = hal::normHamming(qd, train.ptr(j), query.cols);
+                }
+
+                // query 按升序访问且只在严格更小时更新，与 BFMatcher 的取值规则一致
+                for (int j = t0; j < t1; j++)
+                {
+                    int d = dist[j - t0];
+                    if (d < bestDist[j])
+                    {
+                        bestDist[j] = d;
+                        bestQuery[j] = i;
+                    }
+                }
+            }
+        }
+    };
+
+    // 描述符很少时多线程的调度开销得不偿失
+    bool parallel = static_cast<double>(queryRows) * trainRows >= 256.0 * 1024;
+    if (parallel)
+        ThreadPool::shared().parallelFor(blocks, body, threads);
+    else
+        for (int b = 0; b < blocks; b++) body(b);
+}
+
+void HammingMatcher::match(const Mat &query, const Mat &train, std::vector<DMatch> &matches) const
+{
+    matches.clear();
+    if (query.empty() || train.empty()) return;
+    CV_Assert(query.type() == CV_8UC1 && train.type() == CV_8UC1 && query.cols == train.cols);
+
+    std::vector<int> bestQuery, bestDist;
+    nearestQueries(query, train, bestQuery, bestDist);
+
+    // 交叉检验：对每个 query，在以它为最近邻的 train 中取距离最小的一个
+    std::vector<int> nidx(query.rows, -1), ndist(query.rows, INT_MAX);
+    for (int j = 0; j < train.rows; j++)
+    {
+        int i = bestQuery[j];
+        if (bestDist[j] < ndist[i])
+        {
+            ndist[i] = bestDist[j];
+            nidx[i] = j;
+        }
+    }
+
+    for (int i = 0; i < query.rows; i++)
+        if (nidx[i] >= 0) matches.emplace_back(i, nidx[i], 0, static_cast<float>(ndist[i]));
+}
@@ -0,0 +1,39 @@
+#ifndef HAMMINGMATCHER_H
+#define HAMMINGMATCHER_H
+
+#include "opencv2/opencv.hpp"
+
+using namespace cv;
+
+// 二值描述符的暴力匹配器：运行时选择 AVX-512 / AVX2 / 标量的汉明距离内核，
+// 按块遍历 query x train 并多线程执行。结果与 BFMatcher(NORM_HAMMING, true).match 完全一致
+class HammingMatcher
+{
+public:
+    enum Isa
+    {
+        ISA_SCALAR,
+        ISA_AVX2,
+        ISA_AVX512,
+    };
+
+    explicit HammingMatcher(int threads = 0);  // 0 表示使用全部核心
+    ~HammingMatcher();
+
+    static Isa detectIsa();
+    static const char *isaName(Isa isa);
+
+    Isa isa() const { return kernelIsa; }
+    void setIsa(Isa isa);  // 强制使用指定内核（不超过 CPU 支持的最高级别），用于测试和基准
+
+    void match(const Mat &query, const Mat &train, std::vector<DMatch> &matches) const;
+
+private:
+    void nearestQueries(const Mat &query, const Mat &train, std::vector<int> &bestQuery,
+                        std::vector<int> &bestDist) const;
+
+    int threads;
+    Isa kernelIsa;
+};
+
+#endif // HAMMINGMATCHER_H
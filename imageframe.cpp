@@ -0,0 +1,95 @@
+#include "imageframe.h"
+#include "traceprobe.h"
+
+ImageFrame::ImageFrame()
+    : state(std::make_shared<State>())
+{
+}
+
+ImageFrame::ImageFrame(const Mat &pixels, ChannelOrder order)
+    : state(std::make_shared<State>())
+{
+    CV_Assert(pixels.empty() || pixels.channels() == 1 || pixels.channels() == 3);
+    state->pixels = pixels;
+    state->order = pixels.channels() == 1 ? ORDER_GRAY : order;
+    if (state->order == ORDER_GRAY && !pixels.empty())
+    {
+        // 单通道图像本身就是灰度平面
+        CV_Assert(pixels.channels() == 1);
+        state->gray = pixels;
+        state->grayReady = true;
+    }
+}
+
+ImageFrame ImageFrame::load(const std::string &path)
+{
+    Mat pixels = imread(path);
+    if (pixels.empty()) return ImageFrame();
+    return ImageFrame(pixels, ORDER_BGR);
+}
+
+const Mat &ImageFrame::mat() const
+{
+    return state->pixels;
+}
+
+ChannelOrder ImageFrame::order() const
+{
+    return state->order;
+}
+
+int ImageFrame::grayCode() const
+{
+    switch (state->order)
+    {
+    case ORDER_RGB: return COLOR_RGB2GRAY;
+    case ORDER_BGR: return COLOR_BGR2GRAY;
+    default:        return -1;
+    }
+}
+
+const Mat &ImageFrame::gray() const
+{
+    // 同一帧被多个后台操作并发读取时只转换一次，其余调用者等待转换完成
+    std::call_once(state->grayOnce, [this] {
+        if (!state->grayReady && !state->pixels.empty())
+        {
+            TRACE_SCOPE("frame.gray");
+            cvtColor(state->pixels, state->gray, grayCode());
+        }
+        state->grayReady = true;
+    });
+    return state->gray;
+}
+
+bool ImageFrame::hasGray() const
+{
+    return state->grayReady;
+}
+
+Scalar ImageFrame::color(double r, double g, double b) const
+{
+    return state->order == ORDER_BGR ? Scalar(b, g, r) : Scalar(r, g, b);
+}
+
+Mat ImageFrame::toRGB() const
+{
+    if (state->order == ORDER_RGB) return state->pixels;
+    Mat rgb;
+    cvtColor(state->pixels, rgb, state->order == ORDER_BGR ? COLOR_BGR2RGB : COLOR_GRAY2RGB);
+    return rgb;
+}
+
+Mat ImageFrame::toBGR() const
+{
+    if (state->order != ORDER_RGB) return state->pixels;
+    Mat bgr;
+    cvtColor(state->pixels, bgr, COLOR_RGB2BGR);
+    return bgr;
+}
+
+bool ImageFrame::write(const std::string &path, const Mat &pixels, ChannelOrder order)
+{
+    // imwrite 按 BGR 或灰度编码，只有 RGB 图像需要在这里转换一次
+    return imwrite(path, ImageFrame(pixels, order).toBGR());
+}
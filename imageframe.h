@@ -0,0 +1,64 @@
+#ifndef IMAGEFRAME_H
+#define IMAGEFRAME_H
+
+#include "opencv2/opencv.hpp"
+#include <atomic>
+#include <memory>
+#include <mutex>
+
+using namespace cv;
+
+// 像素的通道顺序
+enum ChannelOrder
+{
+    ORDER_RGB,
+    ORDER_BGR,   // imread 和摄像头的原始顺序
+    ORDER_GRAY,
+};
+
+// 带通道顺序的图像：像素保持解码时的顺序，不再为统一成 RGB 而整图转换；
+// 灰度平面在第一次需要时计算并缓存，同一张源图上的各次操作共用。
+// 复制 ImageFrame 只增加引用计数，副本共享同一个灰度缓存，可以交给后台任务并在多个线程中读取；
+// 因此像素在构造后视为只读，标注须画在副本上。
+// 从 Mat 隐式构造时三通道按 RGB 处理，与 CVFunction 原先的约定一致；单通道总是 ORDER_GRAY
+class ImageFrame
+{
+public:
+    ImageFrame();
+    ImageFrame(const Mat &pixels, ChannelOrder order = ORDER_RGB);
+
+    static ImageFrame load(const std::string &path);  // imread 的 BGR 结果，不转换
+
+    const Mat &mat() const;
+    ChannelOrder order() const;
+    bool empty() const { return mat().empty(); }
+    Size size() const { return mat().size(); }
+    int cols() const { return mat().cols; }
+    int rows() const { return mat().rows; }
+
+    const Mat &gray() const;    // 缓存的灰度平面，首次调用时计算，之后只读
+    bool hasGray() const;       // 灰度平面是否已经计算
+    int grayCode() const;       // 转为灰度的 cvtColor 代码，单通道时为 -1
+
+    // 按本图的通道顺序给出 RGB 颜色，在 mat() 的副本上绘制标注时使用
+    Scalar color(double r, double g, double b) const;
+
+    // 以下只在显示和编码的边界调用
+    Mat toRGB() const;   // 已是 RGB 时不复制
+    Mat toBGR() const;   // 已是 BGR 或灰度时不复制，可直接交给 imwrite
+    static bool write(const std::string &path, const Mat &pixels, ChannelOrder order);
+
+private:
+    struct State
+    {
+        Mat pixels;
+        ChannelOrder order = ORDER_RGB;
+        std::once_flag grayOnce;
+        std::atomic<bool> grayReady{false};
+        Mat gray;
+    };
+
+    std::shared_ptr<State> state;
+};
+
+#endif // IMAGEFRAME_H
@@ -1,18 +1,70 @@
 #include "imagepool.h"
 
-ImagePool::ImagePool()
+ImagePool::ImagePool(size_t capacity)
+    : capacity(capacity)
 {
-    Mat src = newImage();
-    Mat dst = newImage();
-    Mat ref = newImage();
-    Mat cut = newImage();
 }
 
 ImagePool::~ImagePool() {}
 
-Mat ImagePool::newImage()
+// 只剩池自身持有引用时缓冲空闲。
+// 后台任务持有的副本可能在工作线程中同时释放，引用计数须与 OpenCV 自身一样以原子操作读取
+bool ImagePool::isIdle(const Mat &buffer)
 {
-    Mat newImg;
-    imageQue.push_back(newImg);
-    return imageQue.back();
+    return buffer.u && CV_XADD(&buffer.u->refcount, 0) == 1;
+}
+
+Mat ImagePool::lease(Size size, int type)
+{
+    counters.leases++;
+    for (const Mat &buffer : buffers)
+    {
+        if (buffer.size() == size && buffer.type() == type && isIdle(buffer))
+            return buffer;
+    }
+
+    // 池已满时先丢弃一个空闲缓冲，所有缓冲都在使用时允许暂时超出容量
+    if (buffers.size() >= capacity)
+    {
+        auto it = std::find_if(buffers.begin(), buffers.end(), isIdle);
+        if (it != buffers.end()) buffers.erase(it);
+    }
+
+    Mat buffer(size, type);
+    counters.allocations++;
+    counters.bytes += buffer.total() * buffer.elemSize();
+    buffers.push_back(buffer);
+    return buffer;
+}
+
+Mat ImagePool::leaseCopy(const Mat &image)
+{
+    if (image.empty()) return Mat();
+    Mat buffer = lease(image.size(), image.type());
+    image.copyTo(buffer);
+    return buffer;
+}
+
+void ImagePool::resetDst()
+{
+    // 先释放旧的 dst，使同尺寸的缓冲能被立即复用
+    dst.release();
+    dst = leaseCopy(src.mat());
+}
+
+void ImagePool::beginOperation()
+{
+    resetDst();
+    cut = src.mat();
+    cuts.clear();
+}
+
+size_t ImagePool::idleCount() const
+{
+    return std::count_if(buffers.begin(), buffers.end(), isIdle);
+}
+
+void ImagePool::trim()
+{
+    buffers.erase(std::remove_if(buffers.begin(), buffers.end(), isIdle), buffers.end());
 }
@@ -2,18 +2,46 @@
 #define IMAGEPOOL_H
 
 #include "opencv2/opencv.hpp"
+#include "preparedtemplate.h"
+#include "imageframe.h"
+#include <memory>
 using namespace cv;
 
+// 按尺寸和类型复用图像缓冲的池。lease() 返回的 Mat 与池共享同一块内存，
+// 当外部所有引用（包括 ROI 视图）都释放后缓冲自动归还，可被下一次租借复用
 class ImagePool
 {
 public:
-    ImagePool();
+    struct Stats
+    {
+        int leases = 0;
+        int allocations = 0;  // 新分配的缓冲数
+        size_t bytes = 0;     // 新分配的字节数
+    };
+
+    explicit ImagePool(size_t capacity = 8);
     ~ImagePool();
-    Mat src, dst, ref, cut;
-    Mat newImage();
+
+    ImageFrame src, ref;           // 保持加载时的通道顺序，灰度平面在各次操作间共用
+    Mat dst, cut;                  // 与 src 通道顺序相同；cut 在导出前保持为 src 的 ROI 视图，不复制
+    std::vector<Mat> cuts;         // 多目标操作的全部剪裁结果，同样是视图
+    std::shared_ptr<PreparedTemplate> refTemplate;  // 由 ref 预处理得到；ref 改变时换成新实例，后台任务仍可使用旧实例
+
+    Mat lease(Size size, int type);
+    Mat leaseCopy(const Mat &image);
+    void resetDst();        // 释放旧的 dst 后从池中取得缓冲并复制 src
+    void beginOperation();  // 重置 dst，cut 指向整幅 src，清空 cuts
+
+    size_t idleCount() const;
+    void trim();  // 释放全部空闲缓冲
+    const Stats &stats() const { return counters; }
 
 private:
-    std::vector<Mat> imageQue;
+    static bool isIdle(const Mat &buffer);
+
+    size_t capacity;
+    std::vector<Mat> buffers;
+    Stats counters;
 };
 
 #endif // IMAGEPOOL_H
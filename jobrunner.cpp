@@ -0,0 +1,91 @@
+#include "jobrunner.h"
+#include <QElapsedTimer>
+#include <exception>
+#include <iostream>
+
+void JobContext::setProgress(int percent, const QString &stage)
+{
+    if (cancelled) return;
+    JobRunner *target = runner;
+    int id = jobId;
+    QMetaObject::invokeMethod(target, [target, id, percent, stage] { target->reportProgress(id, percent, stage); },
+                              Qt::QueuedConnection);
+}
+
+JobRunner::JobRunner(QObject *parent) : QObject(parent)
+{
+    pool.setMaxThreadCount(1);
+}
+
+JobRunner::~JobRunner()
+{
+    if (current) current->cancelled = true;
+    pool.clear();
+    pool.waitForDone();
+}
+
+int JobRunner::submit(const QString &name, const JobResult &initial, Job job)
+{
+    // 取代旧任务：只标记取消，不发 cancelled 信号，界面直接切换到新任务
+    if (current) current->cancelled = true;
+
+    int id = nextId++;
+    std::shared_ptr<JobContext> context(new JobContext(this, id));
+    current = context;
+    emit started(id, name);
+
+    pool.start([this, context, initial, job] {
+        // 排队期间已被取代的任务不再执行
+        if (context->cancelled) return;
+
+        QElapsedTimer timer;
+        timer.start();
+        JobResult result = initial;
+        bool ok = false;
+        // 异常逃出 QThreadPool 的线程会终止进程，改为按失败处理
+        try
+        {
+            ok = job(*context, result);
+        }
+        catch (const cv::Exception &e)
+        {
+            std::cerr << "Error: " << e.what() << std::endl;
+        }
+        catch (const std::exception &e)
+        {
+            std::cerr << "Error: " << e.what() << std::endl;
+        }
+        double elapsedMs = timer.nsecsElapsed() / 1e6;
+
+        int id = context->id();
+        QMetaObject::invokeMethod(this, [this, id, ok, result, elapsedMs] { complete(id, ok, result, elapsedMs); },
+                                  Qt::QueuedConnection);
+    });
+    return id;
+}
+
+void JobRunner::cancel()
+{
+    if (!current) return;
+    current->cancelled = true;
+    int id = current->id();
+    current.reset();
+    emit cancelled(id);
+}
+
+void JobRunner::reportProgress(int id, int percent, const QString &stage)
+{
+    if (current && current->id() == id) emit progress(id, percent, stage);
+}
+
+void JobRunner::complete(int id, bool ok, const JobResult &result, double elapsedMs)
+{
+    // 已被取代或取消的任务，结果直接丢弃
+    if (!current || current->id() != id) return;
+
+    current.reset();
+    if (ok)
+        emit finished(id, result, elapsedMs);
+    else
+        emit failed(id, elapsedMs);
+}
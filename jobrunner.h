@@ -0,0 +1,80 @@
+#ifndef JOBRUNNER_H
+#define JOBRUNNER_H
+
+#include <QObject>
+#include <QString>
+#include <QThreadPool>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include "opencv2/opencv.hpp"
+
+using namespace cv;
+
+class JobRunner;
+
+// 任务的输出，在界面线程中交给 finished 信号
+struct JobResult
+{
+    Mat dst;                // 提交时为 src 的副本，任务在其上绘制标注
+    Mat cut;                // 空表示整幅 src
+    std::vector<Mat> cuts;  // 多目标操作的全部剪裁
+    QString message;        // 非空时显示在状态栏
+    std::function<void()> apply;  // 非空时在界面线程中调用以代替更新图像，用于不产生图像的任务
+};
+
+// 任务在工作线程中持有的上下文：查询取消状态、报告进度
+class JobContext
+{
+public:
+    int id() const { return jobId; }
+    bool isCancelled() const { return cancelled; }
+    void setProgress(int percent, const QString &stage = QString());  // 线程安全，经队列转发到界面线程
+
+private:
+    friend class JobRunner;
+    JobContext(JobRunner *runner, int id) : runner(runner), jobId(id) {}
+
+    JobRunner *runner;
+    int jobId;
+    std::atomic<bool> cancelled{false};
+};
+
+// 把 CVFunction 操作放到后台线程执行的任务队列。新提交的任务取代尚未完成的旧任务：
+// 旧任务被标记取消，在下一个检查点（操作选项中的进度回调）退出，已经算完的结果也不再发出；
+// 没有检查点的操作（整图 matchTemplate、边缘检测等）仍会算完，新任务在其后排队。
+// 只有一个工作线程，任务按提交顺序串行，访问 GrabCut 会话等共享状态无需加锁；
+// 各操作内部已经多线程并行
+class JobRunner : public QObject
+{
+    Q_OBJECT
+
+public:
+    // 返回 false 表示失败或因取消提前退出；任务抛出的异常同样按失败处理
+    using Job = std::function<bool(JobContext &job, JobResult &result)>;
+
+    explicit JobRunner(QObject *parent = nullptr);
+    ~JobRunner();  // 取消当前任务并等待工作线程退出
+
+    int submit(const QString &name, const JobResult &initial, Job job);
+    void cancel();  // 取消当前任务，界面立即回到空闲状态
+    bool isBusy() const { return current != nullptr; }
+
+signals:
+    void started(int id, const QString &name);
+    void progress(int id, int percent, const QString &stage);
+    void finished(int id, const JobResult &result, double elapsedMs);
+    void failed(int id, double elapsedMs);
+    void cancelled(int id);
+
+private:
+    friend class JobContext;
+    void reportProgress(int id, int percent, const QString &stage);
+    void complete(int id, bool ok, const JobResult &result, double elapsedMs);
+
+    QThreadPool pool;
+    std::shared_ptr<JobContext> current;  // 只在界面线程中访问
+    int nextId = 1;
+};
+
+#endif // JOBRUNNER_H
@@ -1,10 +1,17 @@
 #include "mainwindow.h"
+#include "detectorregistry.h"
 
 #include <QApplication>
 
 int main(int argc, char *argv[])
 {
     QApplication a(argc, argv);
+
+    // 级联模型目录可通过环境变量指定，默认仍为 release/
+    QString modelDir = qEnvironmentVariable("OBJECTEXTRACT_MODEL_DIR", "release");
+    DetectorRegistry::instance().setModelDirectory(modelDir.toStdString());
+    DetectorRegistry::instance().warmUp();
+
     MainWindow w;
     w.show();
     return a.exec();
@@ -1,19 +1,77 @@
 #include "mainwindow.h"
 #include "ui_mainwindow.h"
+#include "templatematcher.h"
+#include "facedetector.h"
+#include "traceprobe.h"
+#include <QLabel>
+#include <QProgressBar>
+#include <QPushButton>
 using namespace cv;
 
+// 不小于该像素数的 PPM/PGM 按分块方式打开
+static const double TILED_IMAGE_PIXELS = 100e6;
+// 分块打开时预览图的长边
+static const int TILED_PREVIEW_SIDE = 4096;
+
+// 在预览图上框出原始分辨率下的区域
+static void markPreview(Mat &preview, Rect region, Size full)
+{
+    double sx = static_cast<double>(preview.cols) / full.width, sy = static_cast<double>(preview.rows) / full.height;
+    Rect scaled(cvRound(region.x * sx), cvRound(region.y * sy),
+                std::max(1, cvRound(region.width * sx)), std::max(1, cvRound(region.height * sy)));
+    rectangle(preview, scaled, Scalar(0, 255, 0), 2);
+}
+
+// 把操作的进度回调接到后台任务上：报告进度，取消或被取代后让操作在下一个检查点退出
+static ProgressCallback jobProgressOf(JobContext &job)
+{
+    return [&job](double done) {
+        job.setProgress(cvRound(done * 100));
+        return !job.isCancelled();
+    };
+}
+
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
     , ui(new Ui::MainWindow)
     , imageData(std::make_unique<ImagePool>())
+    , tracker(new TrackPipeline(this))
+    , jobs(new JobRunner(this))
 {
     ui->setupUi(this);
     ui->EditGroup->setVisible(false);
 
+    // 后台任务的状态显示在状态栏右侧，空闲时隐藏
+    jobLabel = new QLabel(this);
+    jobProgress = new QProgressBar(this);
+    jobProgress->setMaximumWidth(160);
+    jobCancel = new QPushButton(tr("取消"), this);
+    ui->statusbar->addPermanentWidget(jobLabel);
+    ui->statusbar->addPermanentWidget(jobProgress);
+    ui->statusbar->addPermanentWidget(jobCancel);
+    jobTimer = new QTimer(this);
+    jobTimer->setInterval(100);
+    endJob();
+
+    displayTimer = new QTimer(this);
+    displayTimer->setSingleShot(true);
+    displayTimer->setInterval(150);
+
+    traceLabel = new QLabel(this);
+    traceLabel->setVisible(false);
+    ui->statusbar->addPermanentWidget(traceLabel);
+    traceTimer = new QTimer(this);
+    traceTimer->setInterval(500);
+
     // File
     connect(ui->actionLoad,         &QAction::triggered, this, &MainWindow::do_loadImage);
     connect(ui->actionSave,         &QAction::triggered, this, &MainWindow::do_saveImage);
     connect(ui->actionReference,    &QAction::triggered, this, &MainWindow::do_loadRef);
+    connect(ui->actionReferenceLibrary, &QAction::triggered, this, &MainWindow::do_loadRefLibrary);
+    // Trace
+    connect(ui->actionTraceEnable,  &QAction::toggled,   this, &MainWindow::do_traceToggled);
+    connect(ui->actionTraceExport,  &QAction::triggered, this, &MainWindow::do_traceExport);
+    connect(traceTimer, &QTimer::timeout, this, &MainWindow::do_traceTick);
     // Caputure
     connect(ui->actionReference_2,  &QAction::triggered, this, &MainWindow::do_loadRefFromCam);
     connect(ui->actionMain,         &QAction::triggered, this, &MainWindow::do_loadImageFromCam);
@@ -22,77 +80,104 @@ MainWindow::MainWindow(QWidget *parent)
     connect(ui->SearchButton,       &QPushButton::clicked, this, &MainWindow::do_templateSearch);
     connect(ui->StartTrackingButton,&QPushButton::clicked, this, &MainWindow::do_startTracing);
     connect(ui->SearchFaceButton,   &QPushButton::clicked, this, &MainWindow::do_faceSearch);
+    connect(ui->FaceStreamButton,   &QPushButton::clicked, this, &MainWindow::do_faceStream);
 
     connect(ui->EdgeDetectionButton,&QPushButton::clicked, this, &MainWindow::do_edgeDetection);
     connect(ui->ThresholdingButton, &QPushButton::clicked, this, &MainWindow::do_thresholding);
+
+    // Track
+    connect(tracker, &TrackPipeline::frameReady,   this, &MainWindow::do_trackFrame);
+    connect(tracker, &TrackPipeline::statsUpdated, this, &MainWindow::do_trackStats);
+    connect(tracker, &TrackPipeline::finished,     this, &MainWindow::do_trackFinished);
+    connect(tracker, &TrackPipeline::objectsDetected, this, [this](const QStringList &names) {
+        // 紧跟在 statsUpdated 之后发出，把识别到的参考名称追加到状态栏
+        if (!names.isEmpty())
+            ui->statusbar->showMessage(ui->statusbar->currentMessage() + "  " + names.join(", "));
+    });
+    connect(tracker, &TrackPipeline::failed,       this, [this](const QString &message) {
+        ui->statusbar->showMessage(message);
+        // 排队期间可能已经重新启动，这时新一轮仍在运行，不能停止
+        if (!tracker->isRunning()) tracker->stop();
+    });
+
+    // Jobs
+    connect(jobs, &JobRunner::progress,  this, &MainWindow::do_jobProgress);
+    connect(jobs, &JobRunner::finished,  this, &MainWindow::do_jobFinished);
+    connect(jobs, &JobRunner::failed,    this, &MainWindow::do_jobFailed);
+    connect(jobs, &JobRunner::cancelled, this, &MainWindow::do_jobCancelled);
+    connect(jobCancel, &QPushButton::clicked, jobs, &JobRunner::cancel);
+    connect(jobTimer, &QTimer::timeout, this, &MainWindow::do_jobTick);
+    connect(displayTimer, &QTimer::timeout, this, &MainWindow::do_displayIdle);
 }
 
 MainWindow::~MainWindow()
 {
+    tracker->stop();
+    delete jobs;  // 等待后台任务退出，之后才能析构它访问的 GrabCut 会话和图像池
     delete ui;
 }
 
 void MainWindow::resizeEvent(QResizeEvent *event)
 {
     QMainWindow::resizeEvent(event);
-    imageDisplay(); // 窗口大小变化时更新图片显示
-    refDisplay();
+    // 拖动窗口期间从缓存的金字塔快速缩放，停止变化一段时间后再平滑重绘
+    showCached(ui->image, imageCache, true);
+    showCached(ui->imageRef, refCache, true);
+    displayTimer->start();
 }
 
 void MainWindow::imageDisplay()
 {
-    QImage myImage(
-        (const unsigned char*)(imageData->dst.data),
-        imageData->dst.cols,
-        imageData->dst.rows,
-        imageData->dst.step,
-        QImage::Format_RGB888
-        );
-    QPixmap pixmap = QPixmap::fromImage(myImage);
-
-    // 缩放图片以适应 QLabel 的大小
-    QSize labelSize = ui->image->size(); // 获取 QLabel 的大小
-    QPixmap scaledPixmap = pixmap.scaled(labelSize, Qt::KeepAspectRatio, Qt::SmoothTransformation);
-
-    ui->image->setPixmap(scaledPixmap);
+    // dst 内容变化后调用：重建显示缓存，缩放到 QLabel 的大小
+    TRACE_SCOPE("display.image");
+    imageCache.setImage(imageData->dst, imageData->src.order());
+    showCached(ui->image, imageCache, false);
 }
 
 void MainWindow::refDisplay()
 {
-    QImage myImage(
-        (const unsigned char*)(imageData->ref.data),
-        imageData->ref.cols,
-        imageData->ref.rows,
-        imageData->ref.step,
-        QImage::Format_RGB888
-        );
-    QPixmap pixmap = QPixmap::fromImage(myImage);
+    TRACE_SCOPE("display.ref");
+    refCache.setImage(imageData->ref.mat(), imageData->ref.order());
+    showCached(ui->imageRef, refCache, false);
+}
 
-    // 缩放图片以适应 QLabel 的大小
-    QSize labelSize = ui->imageRef->size(); // 获取 QLabel 的大小
-    QPixmap scaledPixmap = pixmap.scaled(labelSize, Qt::KeepAspectRatio, Qt::SmoothTransformation);
-    ui->imageRef->setPixmap(scaledPixmap);
+void MainWindow::showCached(QLabel *label, DisplayCache &cache, bool fast)
+{
+    QPixmap pixmap = cache.render(label->size(), fast);
+    // 平滑结果命中缓存时与当前显示的是同一个 QPixmap，不必重新设置
+    TRACE_SCOPE("display.setPixmap");
+    if (label->pixmap().cacheKey() != pixmap.cacheKey()) label->setPixmap(pixmap);
+}
+
+void MainWindow::do_displayIdle()
+{
+    showCached(ui->image, imageCache, false);
+    showCached(ui->imageRef, refCache, false);
 }
 
 void MainWindow::do_loadImage()
 {
-    originalImagePath = QFileDialog::getOpenFileName(this, tr("打开图片"), "", tr("图片文件 (*.png *.jpg *.jpeg *.bmp);;All Files (*)"));
+    originalImagePath = QFileDialog::getOpenFileName(this, tr("打开图片"), "", tr("图片文件 (*.png *.jpg *.jpeg *.bmp *.ppm *.pgm *.pnm);;All Files (*)"));
     if (!originalImagePath.isEmpty())
     {
+        if (loadTiledImage(originalImagePath)) return;
+
         QPixmap pixmap(originalImagePath);
         if (!pixmap.isNull())
         {
             ui->image->clear();
 
-            imageData->src = imread(originalImagePath.toStdString());
+            // 保持 imread 的 BGR 顺序，只在显示和导出时按顺序包装
+            imageData->src = ImageFrame::load(originalImagePath.toStdString());
             if(imageData->src.empty())
             {
                 qDebug() << "Error: Failed to load image data.";
                 return;
             }
 
-            cvtColor(imageData->src, imageData->src, COLOR_BGR2RGB);
-            imageData->dst = imageData->src.clone();
+            jobs->cancel();  // 换图后旧任务的结果不再有意义
+            tiledSource.reset();
+            imageData->resetDst();
             ui->EditGroup->setVisible(true);
             imageDisplay();
             qDebug() << "Selected file path:" << originalImagePath;
@@ -101,15 +186,34 @@ void MainWindow::do_loadImage()
     }
 }
 
+bool MainWindow::loadTiledImage(const QString &path)
+{
+    Size size;
+    int channels;
+    if (!TiledImageSource::probe(path, size, channels) || static_cast<double>(size.width) * size.height < TILED_IMAGE_PIXELS)
+        return false;
+
+    auto source = std::make_shared<TiledImageSource>();
+    if (!source->open(path)) return false;
+
+    // 预览图按行条带从映射区缩放得到，人脸和 GrabCut 在预览图上运行
+    ui->image->clear();
+    jobs->cancel();
+    tiledSource = source;
+    imageData->src = ImageFrame(source->overview(TILED_PREVIEW_SIDE), ORDER_RGB);
+    imageData->resetDst();
+    ui->EditGroup->setVisible(true);
+    imageDisplay();
+    ui->statusbar->showMessage(tr("大图 %1x%2 已映射，模板匹配和边缘检测在原始分辨率上分块运行")
+                                   .arg(size.width).arg(size.height));
+    return true;
+}
+
 void MainWindow::do_saveImage()
 {
-    QImage cutExport(
-        (const unsigned char*)(imageData->cut.data),
-        imageData->cut.cols,
-        imageData->cut.rows,
-        imageData->cut.step,
-        QImage::Format_RGB888
-        );
+    // 剪裁结果与 src 通道顺序相同，按该顺序包装后交给编码器，不做整图转换
+    ChannelOrder order = imageData->src.order();
+    QImage cutExport = DisplayCache::wrap(imageData->cut, order);
 
     QString baseName = QFileInfo(originalImagePath).completeBaseName(); // 获取不带扩展名的文件名
 
@@ -123,6 +227,16 @@ void MainWindow::do_saveImage()
     if (!filename.isEmpty())
     {
         bool saved =cutExport.save(filename);
+
+        // 多个剪裁结果依次保存为 name_1、name_2 ...
+        QFileInfo target(filename);
+        for (size_t i = 1; saved && i < imageData->cuts.size(); i++)
+        {
+            const Mat &crop = imageData->cuts[i];
+            QImage extra = DisplayCache::wrap(crop, order);
+            QString extraName = target.dir().filePath(QString("%1_%2.%3").arg(target.completeBaseName()).arg(i).arg(target.suffix()));
+            saved = extra.save(extraName);
+        }
         if(!saved)
             QMessageBox::warning(this, tr("保存失败"), tr("无法保存图片，请检查文件路径和权限"));
     }
@@ -130,7 +244,7 @@ void MainWindow::do_saveImage()
 
 void MainWindow::do_loadRef()
 {
-    imageData->dst = imageData->src.clone();
+    imageData->resetDst();
 
     originalImagePath = QFileDialog::getOpenFileName(this, tr("打开图片"), "", tr("图片文件 (*.png *.jpg *.jpeg *.bmp);;All Files (*)"));
     if (!originalImagePath.isEmpty())
@@ -138,14 +252,15 @@ void MainWindow::do_loadRef()
         QPixmap pixmap(originalImagePath);
         if (!pixmap.isNull())
         {
-            imageData->ref = imread(originalImagePath.toStdString());
+            imageData->ref = ImageFrame::load(originalImagePath.toStdString());
             if(imageData->ref.empty())
             {
                 qDebug() << "Error: Failed to load reference.";
                 return;
             }
             ui->EditGroup->setVisible(true);
-            cvtColor(imageData->ref, imageData->ref, COLOR_BGR2RGB);
+            imageData->refTemplate = std::make_shared<PreparedTemplate>(imageData->ref);
+            refLibrary.reset();
             refDisplay();
             qDebug() << "Selected ref file path:" << originalImagePath;
         }
@@ -155,9 +270,49 @@ void MainWindow::do_loadRef()
 
 }
 
+void MainWindow::do_loadRefLibrary()
+{
+    QString dir = QFileDialog::getExistingDirectory(this, tr("选择参考图库目录"));
+    if (dir.isEmpty()) return;
+
+    // 数百张参考的解码、ORB 和索引训练放到后台任务中，完成后才替换当前图库；
+    // 与其他操作一样，加载期间开始新的操作会取代本次加载
+    QFileInfoList files = QDir(dir).entryInfoList({"*.png", "*.jpg", "*.jpeg", "*.bmp"}, QDir::Files, QDir::Name);
+    startJob(tr("加载参考图库"), "ref-library", [this, files](JobContext &job, JobResult &result) {
+        auto library = std::make_shared<ReferenceLibrary>();
+        for (int i = 0; i < files.size(); i++)
+        {
+            if (job.isCancelled()) return false;
+            job.setProgress(i * 100 / (files.size() + 1), files[i].fileName());
+            ImageFrame image = ImageFrame::load(files[i].absoluteFilePath().toStdString());
+            if (image.empty()) continue;
+            if (!library->add(files[i].completeBaseName().toStdString(), image))
+                qDebug() << "No features in reference:" << files[i].fileName();
+        }
+
+        if (library->size() > 0)
+        {
+            job.setProgress(files.size() * 100 / (files.size() + 1), tr("建立索引"));
+            library->build();
+        }
+
+        result.apply = [this, library] {
+            if (library->size() == 0)
+            {
+                QMessageBox::warning(this, tr("加载失败"), tr("目录中没有可用的参考图"));
+                return;
+            }
+            refLibrary = library;
+            ui->EditGroup->setVisible(true);
+        };
+        result.message = library->size() > 0 ? tr("已加载参考图库：%1 张").arg(library->size()) : tr("目录中没有可用的参考图");
+        return true;
+    }, false);
+}
+
 void MainWindow::do_loadRefFromCam()
 {
-    imageData->dst = imageData->src.clone();
+    imageData->resetDst();
 
     VideoCapture cap(0);
     if (!cap.isOpened())
@@ -185,9 +340,10 @@ void MainWindow::do_loadRefFromCam()
     cap.release();
     cv::destroyAllWindows();
 
-    imageData->ref = frame.clone();
-    imshow("Reference", imageData->ref);
-    cvtColor(imageData->ref, imageData->ref, COLOR_BGR2RGB);
+    // frame 不再使用，直接接管其缓冲；摄像头帧为 BGR，预览由 refDisplay 按该顺序显示
+    imageData->ref = ImageFrame(frame, ORDER_BGR);
+    imageData->refTemplate = std::make_shared<PreparedTemplate>(imageData->ref);
+    refLibrary.reset();
 
     refDisplay();
     ui->EditGroup->setVisible(true);
@@ -224,9 +380,10 @@ void MainWindow::do_loadImageFromCam()
     cap.release();
     destroyAllWindows();
 
-    imageData->src = frame.clone();
-    cvtColor(imageData->src, imageData->src, COLOR_BGR2RGB);
-    imageData->dst = imageData->src.clone();
+    imageData->src = ImageFrame(frame, ORDER_BGR);
+    jobs->cancel();
+    tiledSource.reset();
+    imageData->resetDst();
 
     ui->EditGroup->setVisible(true);
     imageDisplay();
@@ -235,9 +392,6 @@ void MainWindow::do_loadImageFromCam()
 void MainWindow::do_templateSearch()
 {
     if(imageData->src.empty()) return;
-    imageData->dst = imageData->src.clone();
-    imageData->cut = imageData->src.clone();
-    ui->image->clear();
 
     Method METHOD;
     if      (ui->CCORRButton->isChecked())  METHOD = Method::TM_CCORR;
@@ -249,64 +403,336 @@ void MainWindow::do_templateSearch()
         std::cerr << "Error: ref is empty!" << std::endl;
         return;
     }
-    if (imageData->ref.cols > imageData->src.cols || imageData->ref.rows > imageData->src.rows)
+
+    if (tiledSource)
+    {
+        // 在原始分辨率上逐块匹配，结果框在预览图上标出
+        std::shared_ptr<TiledImageSource> source = tiledSource;
+        std::shared_ptr<const PreparedTemplate> prepared = imageData->refTemplate;
+        startJob(tr("分块模板匹配"), "template-tiled", [=](JobContext &job, JobResult &result) {
+            TiledSourceOptions options;
+            options.progress = jobProgressOf(job);
+            Rect match;
+            result.cut = CVFunction::templateSearch(*source, *prepared, METHOD, options, &match);
+            if (result.cut.empty()) return false;
+            markPreview(result.dst, match, source->size());
+            result.message = tr("匹配位置 (%1, %2)").arg(match.x).arg(match.y);
+            return true;
+        });
+        return;
+    }
+
+    if (imageData->ref.cols() > imageData->src.cols() || imageData->ref.rows() > imageData->src.rows())
     {
         std::cerr << "Error: Template image is larger than source image!" << std::endl;
         return;
     }
 
-    ui->image->clear();
-
-    Mat cutRes;
-    cutRes = CVFunction::templateSearch(imageData->src, imageData->ref, imageData->dst, METHOD);
-    imageDisplay();
-    imageData->cut = cutRes.clone();
+    // 任务持有图像和模板的引用，期间重新加载参考图不影响正在运行的匹配；
+    // 副本共享灰度缓存，同一张图上的后续操作不再转换
+    ImageFrame src = imageData->src, ref = imageData->ref;
+    std::shared_ptr<const PreparedTemplate> prepared = imageData->refTemplate;
+    bool allMatches = ui->AllMatchesBox->isChecked();
+    bool tiled = ui->TiledBox->isChecked();
+    bool pyramid = ui->PyramidBox->isChecked();
+    startJob(tr("模板匹配"), "template", [=](JobContext &job, JobResult &result) {
+        // 整图匹配和全部匹配只有一次 matchTemplate，没有中途的检查点
+        if (allMatches)
+        {
+            std::vector<MatchCandidate> matches;
+            result.cut = CVFunction::templateSearchAll(src, ref, result.dst, METHOD, MultiMatchOptions(), matches);
+            result.message = tr("找到 %1 个匹配").arg(matches.size());
+        }
+        else if (tiled)
+        {
+            TiledOptions options;
+            options.progress = jobProgressOf(job);
+            result.cut = CVFunction::templateSearch(src, ref, result.dst, METHOD, options);
+            return !result.cut.empty();
+        }
+        else if (pyramid)
+        {
+            PyramidOptions options;
+            options.progress = jobProgressOf(job);
+            result.cut = CVFunction::templateSearch(src, ref, result.dst, METHOD, options);
+            return !result.cut.empty();
+        }
+        else
+            result.cut = CVFunction::templateSearch(src, *prepared, result.dst, METHOD);
+        return true;
+    });
 }
 
 void MainWindow::do_startTracing()
 {
-    CVFunction::track(imageData->ref);
+    // 再次点击按钮时停止追踪
+    if (tracker->isRunning())
+    {
+        tracker->stop();
+        return;
+    }
+
+    if (refLibrary)
+    {
+        if (tracker->start(refLibrary))
+            ui->StartTrackingButton->setText(tr("Stop Tracking"));
+        return;
+    }
+
+    if (imageData->ref.empty())
+    {
+        std::cerr << "Error: ref is empty!" << std::endl;
+        return;
+    }
+    if (tracker->start(imageData->ref))
+        ui->StartTrackingButton->setText(tr("Stop Tracking"));
+}
+
+void MainWindow::do_faceStream()
+{
+    // 再次点击按钮时停止
+    if (tracker->isRunning())
+    {
+        tracker->stop();
+        return;
+    }
+
+    FaceStreamOptions options;
+    if (ui->FastFaceBox->isChecked()) options.face.workingSize = 640;
+    if (tracker->start(options))
+        ui->FaceStreamButton->setText(tr("Stop Face Stream"));
+}
+
+void MainWindow::do_trackFrame()
+{
+    TRACE_SCOPE("display.trackFrame");
+    QImage frame = tracker->takeFrame();
+    if (frame.isNull() || !tracker->isRunning()) return;
+    ui->image->setPixmap(QPixmap::fromImage(frame).scaled(ui->image->size(), Qt::KeepAspectRatio, Qt::FastTransformation));
+}
+
+void MainWindow::do_trackStats(int frames, int dropped, int detections, double fps, double latencyMs, bool found)
+{
+    ui->statusbar->showMessage(tr("帧数 %1  丢弃 %2  完整检测 %3  %4 FPS  延迟 %5 ms  %6")
+                                   .arg(frames).arg(dropped).arg(detections).arg(fps, 0, 'f', 1)
+                                   .arg(latencyMs, 0, 'f', 1)
+                                   .arg(found ? tr("已找到目标") : tr("未找到目标")));
+}
+
+void MainWindow::do_trackFinished()
+{
+    ui->StartTrackingButton->setText(tr("Start Tracking"));
+    ui->FaceStreamButton->setText(tr("Face Stream"));
+    showCached(ui->image, imageCache, false);  // 恢复显示 dst，内容未变，直接使用缓存
 }
 
 void MainWindow::do_faceSearch()
 {
     if(imageData->src.empty()) return;
-    imageData->dst = imageData->src.clone();
-    imageData->cut = imageData->src.clone();
-    ui->image->clear();
 
-    Mat cutRes;
-    cutRes = CVFunction::faceSearch(imageData->src, imageData->dst);
-    imageDisplay();
-    imageData->cut = cutRes.clone();
+    ImageFrame src = imageData->src;
+    FaceOptions options;
+    bool fast = ui->FastFaceBox->isChecked();
+    bool allFaces = ui->AllFacesBox->isChecked();
+    if (fast) options.workingSize = 640;
+    startJob(tr("人脸检测"), "face", [=](JobContext &job, JobResult &result) mutable {
+        options.progress = jobProgressOf(job);
+        if (allFaces)
+        {
+            // 导出时保存全部人脸
+            std::vector<FaceResult> faces = CVFunction::faceSearchAll(src, result.dst, options);
+            if (job.isCancelled()) return false;
+            for (const FaceResult &face : faces) result.cuts.push_back(face.crop);
+            if (!faces.empty()) result.cut = faces.front().crop;
+            result.message = tr("检测到 %1 张人脸").arg(faces.size());
+        }
+        else if (fast)
+        {
+            result.cut = CVFunction::faceSearch(src, result.dst, options);
+            return !result.cut.empty();
+        }
+        else
+            result.cut = CVFunction::faceSearch(src, result.dst);  // 原有的整图扫描，没有中途的检查点
+        return true;
+    });
 }
 
 void MainWindow::do_edgeDetection()
 {
     if(imageData->src.empty()) return;
-    imageData->dst = imageData->src.clone();
-    imageData->cut = imageData->src.clone();
-    ui->image->clear();
 
-    Mat cutRes;
-    cutRes = CVFunction::edgeDetection(imageData->src, imageData->dst, 3);
-    imageDisplay();
-    imageData->cut = cutRes.clone();
+    if (tiledSource)
+    {
+        // 边缘图写入临时目录，不进入内存
+        std::shared_ptr<TiledImageSource> source = tiledSource;
+        QString edgePath = QDir::temp().filePath(QFileInfo(source->path()).completeBaseName() + "_edges.pgm");
+        startJob(tr("分块边缘检测"), "edge-tiled", [=](JobContext &job, JobResult &result) {
+            TiledSourceOptions options;
+            options.progress = jobProgressOf(job);
+            Rect bbox;
+            result.cut = CVFunction::edgeDetection(*source, edgePath, options, &bbox);
+            if (result.cut.empty()) return false;
+            markPreview(result.dst, bbox, source->size());
+            result.message = tr("边缘图已写入 %1").arg(edgePath);
+            return true;
+        });
+        return;
+    }
+
+    ImageFrame src = imageData->src;
+    startJob(tr("边缘检测"), "edge", [src](JobContext &, JobResult &result) {
+        result.cut = CVFunction::edgeDetection(src, result.dst, 3);
+        return true;
+    });
 }
 
 void MainWindow::do_thresholding()
 {
     if(imageData->src.empty()) return;
-    imageData->dst = imageData->src.clone();
-    imageData->cut = imageData->src.clone();
-    ui->image->clear();
 
-    Mat cutRes;
-    cutRes = CVFunction::grabcutForegroundExtraction(imageData->src, imageData->dst);
-    imageDisplay();
-    imageData->cut = cutRes.clone();
+    ImageFrame src = imageData->src;
+    GrabCutOptions options;
+    // 长边缩放到约 800 像素粗分割，再在原始分辨率上细化边界
+    if (ui->FastGrabCutBox->isChecked())
+        options.scale = std::min(1.0, 800.0 / std::max(src.cols(), src.rows()));
+    bool keepSession = ui->KeepGrabCutBox->isChecked();
+    GrabCutSession *session = &grabcutSession;
+
+    startJob(tr("GrabCut"), "grabcut", [=](JobContext &job, JobResult &result) mutable {
+        // 逐次迭代并报告进度，取消后在下一次迭代或下一个分块前退出
+        options.progress = jobProgressOf(job);
+
+        if (keepSession)
+        {
+            // 再次点击时在保留的掩码和模型上追加一轮迭代，换图后则作为同一场景的热启动
+            if (!session->isActive()) session->setOptions(options);
+            result.cut = CVFunction::grabcutForegroundExtraction(src, result.dst, *session);
+            result.message = tr("GrabCut 累计迭代 %1 次").arg(session->totalIterations());
+        }
+        else
+        {
+            session->reset();
+            result.cut = CVFunction::grabcutForegroundExtraction(src, result.dst, options);
+        }
+        return !result.cut.empty();
+    });
+}
+
+void MainWindow::startJob(const QString &title, const char *operation, JobRunner::Job job, bool drawsOnSrc)
+{
+    // 结果画在池中租借的 src 副本上，任务完成前界面继续显示上一次的结果
+    jobPoolBefore = imageData->stats();
+    jobOperation = operation;
+    jobTitle = title;
+    jobStage.clear();
+    JobResult initial;
+    if (drawsOnSrc) initial.dst = imageData->leaseCopy(imageData->src.mat());
+    jobs->submit(title, initial, std::move(job));
+
+    jobClock.start();
+    jobTimer->start();
+    jobProgress->setRange(0, 0);  // 收到第一次进度前显示为忙碌
+    jobProgress->setVisible(true);
+    jobCancel->setVisible(true);
+    jobLabel->setVisible(true);
+    do_jobTick();
+}
+
+void MainWindow::endJob()
+{
+    jobTimer->stop();
+    jobProgress->setVisible(false);
+    jobCancel->setVisible(false);
+    jobLabel->setVisible(false);
+}
+
+void MainWindow::do_jobProgress(int id, int percent, const QString &stage)
+{
+    Q_UNUSED(id);
+    jobProgress->setRange(0, 100);
+    jobProgress->setValue(percent);
+    jobStage = stage;
+    do_jobTick();
 }
 
+void MainWindow::do_jobFinished(int id, const JobResult &result, double elapsedMs)
+{
+    Q_UNUSED(id);
+    endJob();
+    if (result.apply)
+        result.apply();
+    else
+    {
+        imageData->dst = result.dst;
+        imageData->cut = result.cut.empty() ? imageData->src.mat() : result.cut;  // 保持为 ROI 视图，导出时再写出
+        imageData->cuts = result.cuts;
+        imageDisplay();
+    }
 
+    QString done = tr("%1 完成，用时 %2 s").arg(jobTitle).arg(elapsedMs / 1000, 0, 'f', 2);
+    ui->statusbar->showMessage(result.message.isEmpty() ? done : result.message + "  " + done);
+    logPoolUsage(jobOperation, jobPoolBefore);
+}
 
+void MainWindow::do_jobFailed(int id, double elapsedMs)
+{
+    Q_UNUSED(id);
+    endJob();
+    ui->statusbar->showMessage(tr("%1 失败，用时 %2 s").arg(jobTitle).arg(elapsedMs / 1000, 0, 'f', 2));
+}
 
+void MainWindow::do_jobCancelled(int id)
+{
+    Q_UNUSED(id);
+    endJob();
+    ui->statusbar->showMessage(tr("%1 已取消").arg(jobTitle));
+}
+
+void MainWindow::do_jobTick()
+{
+    QString stage = jobStage.isEmpty() ? QString() : " " + jobStage;
+    jobLabel->setText(tr("%1%2  %3 s").arg(jobTitle, stage).arg(jobClock.elapsed() / 1000.0, 0, 'f', 1));
+}
+
+void MainWindow::logPoolUsage(const char *operation, const ImagePool::Stats &before)
+{
+    const ImagePool::Stats &now = imageData->stats();
+    qDebug() << operation << "buffers leased:" << now.leases - before.leases
+             << "allocated:" << now.allocations - before.allocations
+             << "bytes:" << qulonglong(now.bytes - before.bytes);
+}
+
+void MainWindow::do_traceToggled(bool on)
+{
+    TraceProbe::setEnabled(on);
+    traceLabel->setVisible(on);
+    if (on)
+    {
+        TraceProbe::clear();  // 只导出本次开启之后的事件
+        traceTimer->start();
+        do_traceTick();
+    }
+    else
+        traceTimer->stop();
+}
+
+void MainWindow::do_traceExport()
+{
+    QString filename = QFileDialog::getSaveFileName(this, tr("导出计时"), "trace.json", tr("Chrome Trace (*.json)"));
+    if (filename.isEmpty()) return;
+    if (!TraceProbe::exportChrome(filename.toStdString()))
+        QMessageBox::warning(this, tr("导出失败"), tr("无法写入文件，请检查文件路径和权限"));
+    else
+        ui->statusbar->showMessage(tr("已导出计时，可在 Perfetto 或 chrome://tracing 中打开"));
+}
+
+void MainWindow::do_traceTick()
+{
+    // 最近一秒总耗时最多的四个阶段：平均耗时和次数
+    QStringList parts;
+    std::vector<TraceStage> stages = TraceProbe::stages(1000);
+    for (size_t i = 0; i < stages.size() && i < 4; i++)
+        parts << QString("%1 %2 ms x%3").arg(QString::fromStdString(stages[i].name))
+                     .arg(stages[i].meanMs, 0, 'f', 2).arg(stages[i].count);
+    traceLabel->setText(parts.isEmpty() ? tr("计时：无事件") : parts.join("  "));
+}
@@ -5,8 +5,19 @@
 #include <QFileDialog>
 #include <QScreen>
 #include <QMessageBox>
+#include <QElapsedTimer>
+#include <QTimer>
 #include "imagepool.h"
 #include "cvfunction.h"
+#include "trackpipeline.h"
+#include "grabcutsession.h"
+#include "jobrunner.h"
+#include "displaycache.h"
+#include "tiledsource.h"
+
+class QLabel;
+class QProgressBar;
+class QPushButton;
 
 QT_BEGIN_NAMESPACE
 namespace Ui {
@@ -31,17 +42,58 @@ private slots:
     void do_loadImage();
     void do_saveImage();
     void do_loadRef();
+    void do_loadRefLibrary();
     void do_loadRefFromCam();
     void do_loadImageFromCam();
     void do_templateSearch();
     void do_startTracing();
+    void do_faceStream();
     void do_faceSearch();
     void do_edgeDetection();
     void do_thresholding();
+    void do_trackFrame();
+    void do_trackStats(int frames, int dropped, int detections, double fps, double latencyMs, bool found);
+    void do_trackFinished();
+    void do_jobProgress(int id, int percent, const QString &stage);
+    void do_jobFinished(int id, const JobResult &result, double elapsedMs);
+    void do_jobFailed(int id, double elapsedMs);
+    void do_jobCancelled(int id);
+    void do_jobTick();
+    void do_displayIdle();
+    void do_traceToggled(bool on);
+    void do_traceExport();
+    void do_traceTick();
 
 private:
+    void logPoolUsage(const char *operation, const ImagePool::Stats &before);  // 输出一次操作的缓冲分配情况
+    // 提交后台任务，取代未完成的旧任务；drawsOnSrc 为 false 时不准备 src 的副本
+    void startJob(const QString &title, const char *operation, JobRunner::Job job, bool drawsOnSrc = true);
+    void endJob();
+    void showCached(QLabel *label, DisplayCache &cache, bool fast);
+    bool loadTiledImage(const QString &path);  // 超大的 PPM/PGM 映射后只解码预览图
+
     Ui::MainWindow *ui;
     std::unique_ptr<ImagePool> imageData;
+    TrackPipeline *tracker;
+    std::shared_ptr<ReferenceLibrary> refLibrary;  // 非空时追踪参考图库中的全部目标
+    std::shared_ptr<TiledImageSource> tiledSource; // 非空时 src 只是预览，模板匹配和边缘检测在映射的原图上分块运行
+    GrabCutSession grabcutSession;                 // 勾选保留会话时跨点击保存 GrabCut 掩码和颜色模型，只在任务线程中访问
+
+    JobRunner *jobs;
+    QLabel *jobLabel;
+    QProgressBar *jobProgress;
+    QPushButton *jobCancel;
+    QTimer *jobTimer;           // 任务运行期间定时刷新已用时间
+    QElapsedTimer jobClock;
+    QString jobTitle, jobStage;
+    const char *jobOperation = "";
+    ImagePool::Stats jobPoolBefore;
+
+    DisplayCache imageCache, refCache;  // dst 和 ref 的显示金字塔，只在内容变化时重建
+    QTimer *displayTimer;               // 窗口停止缩放后触发平滑重绘
+
+    QLabel *traceLabel;  // 开启计时探针时显示最近一秒耗时最多的几个阶段
+    QTimer *traceTimer;
 
     QString originalImagePath;
 };
@@ -0,0 +1,181 @@
+#include "objecttracker.h"
+#include "traceprobe.h"
+
+ObjectTracker::ObjectTracker(const ImageFrame &ref, const TrackerOptions &options)
+    : options(options)
+    , orb(ORB::create())
+    , fallbackOrb(ORB::create())
+    , refSize(ref.size())
+{
+    // 计算参考图像的关键点和描述符
+    orb->detectAndCompute(ref.gray(), Mat(), kpRef, desRef);
+}
+
+ObjectTracker::~ObjectTracker() {}
+
+void ObjectTracker::extract(const Mat &gray, TrackFeatures &features)
+{
+    // 检测当前帧的关键点和描述符
+    TRACE_SCOPE("track.orb");
+    orb->detectAndCompute(gray, Mat(), features.keypoints, features.descriptors);
+    features.extracted = true;
+}
+
+TrackResult ObjectTracker::locate(const TrackFeatures &features) const
+{
+    return locate(features, nullptr, nullptr);
+}
+
+TrackResult ObjectTracker::locate(const TrackFeatures &features, std::vector<Point2f> *refInliers,
+                                  std::vector<Point2f> *frameInliers) const
+{
+    TrackResult result;
+    result.detected = true;
+    if (features.descriptors.empty() || desRef.empty()) return result;
+
+    // 匹配特征点
+    TRACE_STAGE(stage, "track.match");
+    std::vector<DMatch> matches;
+    matcher.match(desRef, features.descriptors, matches);
+    result.matches = static_cast<int>(matches.size());
+    keepBest(matches, options.maxMatches);
+
+    // 提取匹配点的位置
+    std::vector<Point2f> src_pts, dst_pts;
+    for (size_t i = 0; i < matches.size(); ++i)
+    {
+        src_pts.push_back(kpRef[matches[i].queryIdx].pt);
+        dst_pts.push_back(features.keypoints[matches[i].trainIdx].pt);
+    }
+    if (src_pts.size() <= 4) return result;
+
+    // 计算单应性矩阵并求出参考图四个角的位置
+    TRACE_NEXT(stage, "track.homography");
+    Mat inlierMask;
+    Mat H = findHomography(src_pts, dst_pts, RANSAC, 5.0, inlierMask);
+    if (H.empty()) return result;
+
+    corners(H, result);
+    result.inliers = countNonZero(inlierMask);
+
+    if (refInliers && frameInliers)
+    {
+        for (size_t i = 0; i < src_pts.size(); i++)
+        {
+            if (!inlierMask.at<uchar>(static_cast<int>(i))) continue;
+            refInliers->push_back(src_pts[i]);
+            frameInliers->push_back(dst_pts[i]);
+        }
+    }
+    return result;
+}
+
+TrackResult ObjectTracker::track(const Mat &gray, const TrackFeatures &features)
+{
+    TrackResult result;
+    if (options.incremental && flowReady && !features.extracted)
+    {
+        if (flow(gray, result)) return result;
+        flowReady = false;
+    }
+
+    // 完整检测：特征提取线程已跳过本帧时在这里补做；已提取但本帧没有特征时不再重复
+    TrackFeatures own;
+    const TrackFeatures *current = &features;
+    if (!features.extracted)
+    {
+        TRACE_SCOPE("track.orb");
+        fallbackOrb->detectAndCompute(gray, Mat(), own.keypoints, own.descriptors);
+        own.extracted = true;
+        current = &own;
+    }
+
+    refPts.clear();
+    framePts.clear();
+    result = locate(*current, &refPts, &framePts);
+
+    // 内点足够时建立光流跟踪点，后续帧不再做 ORB
+    if (options.incremental && result.found && result.inliers >= options.minInliers)
+    {
+        prevGray = gray.clone();
+        flowFrames = 0;
+        flowReady = true;
+    }
+    return result;
+}
+
+bool ObjectTracker::flow(const Mat &gray, TrackResult &result)
+{
+    if (++flowFrames > options.maxFlowFrames) return false;
+    TRACE_SCOPE("track.flow");
+
+    std::vector<Point2f> nextPts;
+    std::vector<uchar> status;
+    std::vector<float> err;
+    calcOpticalFlowPyrLK(prevGray, gray, framePts, nextPts, status, err);
+
+    std::vector<Point2f> refKept, nextKept;
+    for (size_t i = 0; i < status.size(); i++)
+    {
+        if (!status[i]) continue;
+        refKept.push_back(refPts[i]);
+        nextKept.push_back(nextPts[i]);
+    }
+    if (static_cast<int>(refKept.size()) < options.minInliers) return false;
+
+    Mat inlierMask;
+    Mat H = findHomography(refKept, nextKept, RANSAC, options.maxReprojError, inlierMask);
+    if (H.empty()) return false;
+
+    // 用全部跟踪点的平均重投影误差衡量单应性是否仍然可靠。RANSAC 已剔除误差超过阈值的点，
+    // 只在内点上求平均永远不会超过阈值；漂移的点计入平均后，跟踪退化时才会回退到 ORB
+    std::vector<Point2f> projected;
+    perspectiveTransform(refKept, projected, H);
+    std::vector<Point2f> refInliers, frameInliers;
+    double error = 0;
+    for (size_t i = 0; i < refKept.size(); i++)
+    {
+        error += norm(projected[i] - nextKept[i]);
+        if (!inlierMask.at<uchar>(static_cast<int>(i))) continue;
+        refInliers.push_back(refKept[i]);
+        frameInliers.push_back(nextKept[i]);
+    }
+
+    int inliers = static_cast<int>(refInliers.size());
+    if (inliers == 0 || inliers < options.minInliers || error / refKept.size() > options.maxReprojError) return false;
+
+    refPts.swap(refInliers);
+    framePts.swap(frameInliers);
+    gray.copyTo(prevGray);
+
+    corners(H, result);
+    result.matches = static_cast<int>(refKept.size());
+    result.inliers = inliers;
+    return true;
+}
+
+void ObjectTracker::corners(const Mat &H, TrackResult &result) const
+{
+    std::vector<Point2f> pts = {Point2f(0, 0), Point2f(0, refSize.height - 1),
+                                Point2f(refSize.width - 1, refSize.height - 1), Point2f(refSize.width - 1, 0)};
+    perspectiveTransform(pts, result.corners, H);
+    result.found = true;
+}
+
+void ObjectTracker::keepBest(std::vector<DMatch> &matches, int k)
+{
+    if (k <= 0 || matches.size() <= static_cast<size_t>(k)) return;
+    std::nth_element(matches.begin(), matches.begin() + k, matches.end(), [](const DMatch &a, const DMatch &b) {
+        return a.distance < b.distance;
+    });
+    matches.resize(k);
+}
+
+void ObjectTracker::draw(Mat &frame, const TrackResult &result)
+{
+    if (!result.found) return;
+
+    std::vector<Point> dst_int;
+    for (const auto &pt : result.corners) dst_int.emplace_back(static_cast<int>(pt.x), static_cast<int>(pt.y));
+    polylines(frame, dst_int, true, Scalar(0, 255, 0), 3);
+}
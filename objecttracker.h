@@ -0,0 +1,79 @@
+#ifndef OBJECTTRACKER_H
+#define OBJECTTRACKER_H
+
+#include "opencv2/opencv.hpp"
+#include "opencv2/features2d.hpp"
+#include "hammingmatcher.h"
+#include "imageframe.h"
+#include <atomic>
+
+using namespace cv;
+
+struct TrackFeatures
+{
+    std::vector<KeyPoint> keypoints;
+    Mat descriptors;
+    bool extracted = false;  // 已做过 ORB；为 false 表示特征提取线程跳过了本帧，描述符为空不代表没有特征
+};
+
+struct TrackResult
+{
+    bool found = false;
+    bool detected = false;         // 本帧是否做了完整的 ORB 检测与匹配
+    std::vector<Point2f> corners;  // 参考图四个角在当前帧中的位置
+    int matches = 0;
+    int inliers = 0;
+};
+
+struct TrackerOptions
+{
+    bool incremental = true;      // 单应性稳定后改用光流逐帧跟踪内点
+    int minInliers = 15;          // 内点少于该值时回退到完整检测
+    double maxReprojError = 3.0;  // 光流跟踪点的平均重投影误差（像素）超过该值时回退，同时是 RANSAC 的内点阈值
+    int maxFlowFrames = 60;       // 连续光流跟踪的最大帧数，防止误差累积
+    int maxMatches = 0;           // 只用距离最小的前 k 个匹配估计单应性，0 表示全部使用
+};
+
+// 基于 ORB 特征的目标定位，特征提取和匹配拆成两步，便于放到不同线程。
+// 增量模式下找到目标后用光流跟踪内点并更新单应性，只有跟踪质量下降时才重新做 ORB
+class ObjectTracker
+{
+public:
+    explicit ObjectTracker(const ImageFrame &ref, const TrackerOptions &options = TrackerOptions());
+    ~ObjectTracker();
+
+    bool valid() const { return !desRef.empty(); }
+    bool needsDetection() const { return !options.incremental || !flowReady; }
+
+    void extract(const Mat &gray, TrackFeatures &features);            // gray 为当前帧灰度图
+    TrackResult locate(const TrackFeatures &features) const;            // 完整匹配，不改变跟踪状态
+
+    // 跟踪一帧：features 为空时尝试光流跟踪，否则做完整匹配并重新建立跟踪点
+    TrackResult track(const Mat &gray, const TrackFeatures &features);
+    static void draw(Mat &frame, const TrackResult &result);
+
+    // 部分选择出距离最小的 k 个匹配（不保证顺序），k <= 0 时保持不变
+    static void keepBest(std::vector<DMatch> &matches, int k);
+
+private:
+    TrackResult locate(const TrackFeatures &features, std::vector<Point2f> *refInliers,
+                       std::vector<Point2f> *frameInliers) const;
+    bool flow(const Mat &gray, TrackResult &result);
+    void corners(const Mat &H, TrackResult &result) const;
+
+    TrackerOptions options;
+    Ptr<ORB> orb;          // 特征提取线程使用
+    Ptr<ORB> fallbackOrb;  // 跟踪线程在缺少特征时使用
+    HammingMatcher matcher;  // 与 BFMatcher(NORM_HAMMING, true) 结果一致
+    std::vector<KeyPoint> kpRef;
+    Mat desRef;
+    Size refSize;
+
+    // 增量跟踪状态，只在 track() 所在线程中访问
+    std::atomic<bool> flowReady{false};
+    Mat prevGray;
+    std::vector<Point2f> refPts, framePts;
+    int flowFrames = 0;
+};
+
+#endif // OBJECTTRACKER_H
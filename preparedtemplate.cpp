@@ -0,0 +1,161 @@
+#include "preparedtemplate.h"
+#include <cfloat>
+
+PreparedTemplate::PreparedTemplate() {}
+
+PreparedTemplate::PreparedTemplate(const ImageFrame &ref)
+{
+    reset(ref);
+}
+
+PreparedTemplate::~PreparedTemplate() {}
+
+void PreparedTemplate::reset(const ImageFrame &ref)
+{
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    spectra.clear();
+
+    if (ref.empty())
+    {
+        grayRef.release();
+        floatRef.release();
+        return;
+    }
+
+    // 复制一份，模板之后不依赖 ref 的生命周期；灰度平面同时留在 ref 中供其他操作复用
+    grayRef = ref.gray().clone();
+    grayRef.convertTo(floatRef, CV_32F);
+
+    // 归一化方法所需的模板统计量只算一次
+    Scalar mean, sdv;
+    meanStdDev(grayRef, mean, sdv);
+    templMean = mean[0];
+    templVar = sdv[0] * sdv[0];
+    templSumSq = (templVar + templMean * templMean) * grayRef.total();
+}
+
+Size PreparedTemplate::dftSizeFor(Size srcSize)
+{
+    // 只需要有效区域的相关结果，DFT 尺寸覆盖源图即可，不会发生循环混叠
+    return Size(getOptimalDFTSize(srcSize.width), getOptimalDFTSize(srcSize.height));
+}
+
+Mat PreparedTemplate::spectrum(Size dftSize) const
+{
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    for (const auto &entry : spectra)
+        if (entry.first == dftSize) return entry.second;
+
+    Mat padded = Mat::zeros(dftSize, CV_32F);
+    floatRef.copyTo(padded(Rect(0, 0, floatRef.cols, floatRef.rows)));
+    Mat spec;
+    dft(padded, spec, 0, floatRef.rows);
+    spectra.emplace_back(dftSize, spec);
+    return spec;
+}
+
+void PreparedTemplate::match(const Mat &srcGray, Mat &result, Method METHOD) const
+{
+    MatchWorkspace ws;
+    match(srcGray, result, METHOD, ws);
+}
+
+void PreparedTemplate::match(const Mat &srcGray, Mat &result, Method METHOD, MatchWorkspace &ws) const
+{
+    CV_Assert(!empty() && srcGray.type() == CV_8UC1);
+    CV_Assert(srcGray.cols >= grayRef.cols && srcGray.rows >= grayRef.rows);
+
+    int resCols = srcGray.cols - grayRef.cols + 1;
+    int resRows = srcGray.rows - grayRef.rows + 1;
+    Size dftSize = dftSizeFor(srcGray.size());
+
+    // 源图补零到 DFT 尺寸，只清零补边部分
+    ws.padded.create(dftSize, CV_32F);
+    Mat srcArea = ws.padded(Rect(0, 0, srcGray.cols, srcGray.rows));
+    srcGray.convertTo(srcArea, CV_32F);
+    if (dftSize.width > srcGray.cols)
+        ws.padded(Rect(srcGray.cols, 0, dftSize.width - srcGray.cols, srcGray.rows)).setTo(Scalar(0));
+    if (dftSize.height > srcGray.rows)
+        ws.padded(Rect(0, srcGray.rows, dftSize.width, dftSize.height - srcGray.rows)).setTo(Scalar(0));
+
+    // 互相关 = IDFT(F(src) * conj(F(ref)))，模板频谱来自缓存
+    dft(ws.padded, ws.spectrum, 0, srcGray.rows);
+    mulSpectrums(ws.spectrum, spectrum(dftSize), ws.spectrum, 0, true);
+    dft(ws.spectrum, ws.corr, DFT_INVERSE | DFT_SCALE | DFT_REAL_OUTPUT, resRows);
+
+    result.create(resRows, resCols, CV_32F);
+    ws.corr(Rect(0, 0, resCols, resRows)).copyTo(result);
+
+    if (METHOD == Method::TM_CCORR) return;
+
+    if (METHOD == Method::TM_CCOEFF)
+        integral(srcGray, ws.sum, CV_64F);
+    else
+        integral(srcGray, ws.sum, ws.sqsum, CV_64F, CV_64F);
+    normalizeScores(result, METHOD, ws.sum, ws.sqsum);
+}
+
+// 与 OpenCV 内部 common_matchTemplate 相同的归一化，模板统计量使用缓存值
+void PreparedTemplate::normalizeScores(Mat &result, Method METHOD, const Mat &sum, const Mat &sqsum) const
+{
+    bool isCoeff = METHOD == Method::TM_CCOEFF || METHOD == Method::TM_CCOEFF_NORMED;
+    bool isSqdiff = METHOD == Method::TM_SQDIFF || METHOD == Method::TM_SQDIFF_NORMED;
+    bool isNormed = METHOD == Method::TM_CCORR_NORMED || METHOD == Method::TM_SQDIFF_NORMED ||
+                    METHOD == Method::TM_CCOEFF_NORMED;
+
+    double area = static_cast<double>(grayRef.total());
+    double invArea = 1.0 / area;
+
+    if (METHOD == Method::TM_CCOEFF_NORMED && templVar < DBL_EPSILON)
+    {
+        result = Scalar::all(1);
+        return;
+    }
+
+    double mean = isCoeff ? templMean : 0;
+    double templNorm = std::sqrt(isCoeff ? templVar : templSumSq * invArea) / std::sqrt(invArea);
+
+    int tw = grayRef.cols, th = grayRef.rows;
+    for (int y = 0; y < result.rows; y++)
+    {
+        float *row = result.ptr<float>(y);
+        const double *s0 = sum.ptr<double>(y), *s1 = sum.ptr<double>(y + th);
+        const double *q0 = sqsum.empty() ? nullptr : sqsum.ptr<double>(y);
+        const double *q1 = sqsum.empty() ? nullptr : sqsum.ptr<double>(y + th);
+
+        for (int x = 0; x < result.cols; x++)
+        {
+            double num = row[x];
+            double wndMean2 = 0, wndSum2 = 0;
+
+            if (isCoeff)
+            {
+                double t = s0[x] - s0[x + tw] - s1[x] + s1[x + tw];
+                wndMean2 = t * t * invArea;
+                num -= t * mean;
+            }
+
+            if (isNormed || isSqdiff)
+            {
+                wndSum2 = q0[x] - q0[x + tw] - q1[x] + q1[x + tw];
+                if (isSqdiff)
+                    num = std::max(wndSum2 - 2 * num + templSumSq, 0.0);
+            }
+
+            if (isNormed)
+            {
+                double diff2 = std::max(wndSum2 - wndMean2, 0.0);
+                double t = diff2 <= std::min(0.5, 10 * FLT_EPSILON * wndSum2) ? 0 : std::sqrt(diff2) * templNorm;
+
+                if (std::fabs(num) < t)
+                    num /= t;
+                else if (std::fabs(num) < t * 1.125)
+                    num = num > 0 ? 1 : -1;
+                else
+                    num = METHOD != Method::TM_SQDIFF_NORMED ? 0 : 1;
+            }
+
+            row[x] = static_cast<float>(num);
+        }
+    }
+}
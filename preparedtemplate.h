@@ -0,0 +1,55 @@
+#ifndef PREPAREDTEMPLATE_H
+#define PREPAREDTEMPLATE_H
+
+#include "opencv2/opencv.hpp"
+#include "cvfunction.h"
+#include "imageframe.h"
+#include <mutex>
+
+using namespace cv;
+
+// 频域匹配的中间缓冲区，重复使用时可避免每次重新分配
+struct MatchWorkspace
+{
+    Mat padded;    // 补零后的源图（CV_32F）
+    Mat spectrum;  // 源图频谱，之后原地乘以模板频谱的共轭
+    Mat corr;      // 逆变换得到的互相关
+    Mat sum, sqsum;
+};
+
+// 预处理过的参考模板：一次性缓存灰度数据、统计量和各 DFT 尺寸下的模板频谱，
+// 同一个模板对大量源图反复匹配时不再重复这些计算
+class PreparedTemplate
+{
+public:
+    PreparedTemplate();
+    explicit PreparedTemplate(const ImageFrame &ref);
+    ~PreparedTemplate();
+
+    void reset(const ImageFrame &ref);  // 灰度数据取自 ref 的灰度平面
+    bool empty() const { return grayRef.empty(); }
+    Size size() const { return grayRef.size(); }
+    const Mat &gray() const { return grayRef; }
+
+    // 输出与 matchTemplate(srcGray, gray(), result, METHOD) 一致
+    void match(const Mat &srcGray, Mat &result, Method METHOD) const;
+    void match(const Mat &srcGray, Mat &result, Method METHOD, MatchWorkspace &ws) const;
+
+    static Size dftSizeFor(Size srcSize);
+    Mat spectrum(Size dftSize) const;  // 指定 DFT 尺寸下的模板频谱（首次调用时计算并缓存）
+
+    // 把互相关结果按 METHOD 换算为得分，sum/sqsum 为源图灰度的 CV_64F 积分图（TM_CCOEFF 不需要 sqsum）
+    void normalizeScores(Mat &result, Method METHOD, const Mat &sum, const Mat &sqsum) const;
+
+private:
+    Mat grayRef;
+    Mat floatRef;
+    double templMean = 0;  // 模板均值
+    double templVar = 0;   // 模板方差
+    double templSumSq = 0; // 模板像素平方和
+
+    mutable std::mutex cacheMutex;
+    mutable std::vector<std::pair<Size, Mat>> spectra;
+};
+
+#endif // PREPAREDTEMPLATE_H
@@ -0,0 +1,106 @@
+#include "referencelibrary.h"
+
+ReferenceLibrary::ReferenceLibrary(const LibraryOptions &options)
+    : options(options)
+    , orb(ORB::create())
+    , matcher(makePtr<flann::LshIndexParams>(options.tables, options.keySize, options.multiProbeLevel))
+{
+}
+
+ReferenceLibrary::~ReferenceLibrary() {}
+
+bool ReferenceLibrary::add(const std::string &name, const ImageFrame &image)
+{
+    Entry entry;
+    entry.name = name;
+    entry.size = image.size();
+
+    orb->detectAndCompute(image.gray(), Mat(), entry.keypoints, entry.descriptors);
+    if (entry.descriptors.empty()) return false;
+
+    entries.push_back(std::move(entry));
+    built = false;
+    return true;
+}
+
+void ReferenceLibrary::build()
+{
+    // 每个参考的描述符作为一张训练图加入，匹配结果的 imgIdx 即参考编号
+    std::vector<Mat> descriptors;
+    for (const Entry &entry : entries) descriptors.push_back(entry.descriptors);
+
+    matcher.clear();
+    matcher.add(descriptors);
+    matcher.train();
+    built = true;
+}
+
+std::vector<LibraryDetection> ReferenceLibrary::detect(const TrackFeatures &features)
+{
+    std::vector<LibraryDetection> detections;
+    if (entries.empty() || features.descriptors.empty()) return detections;
+    if (!built) build();
+
+    std::vector<std::vector<DMatch>> knn;
+    matcher.knnMatch(features.descriptors, knn, 2);
+
+    // 比值检验后按参考分组投票
+    std::vector<std::vector<DMatch>> votes(entries.size());
+    for (const std::vector<DMatch> &pair : knn)
+    {
+        if (pair.empty()) continue;
+        if (pair.size() > 1 && pair[0].distance >= options.ratio * pair[1].distance) continue;
+        votes[pair[0].imgIdx].push_back(pair[0]);
+    }
+
+    for (size_t i = 0; i < entries.size(); i++)
+    {
+        std::vector<DMatch> &matches = votes[i];
+        int voteCount = static_cast<int>(matches.size());
+        if (voteCount < options.minVotes) continue;
+
+        // 只需要距离最小的前 k 个匹配，不必整体排序
+        ObjectTracker::keepBest(matches, options.maxMatches);
+
+        const Entry &entry = entries[i];
+        std::vector<Point2f> refPts, framePts;
+        for (const DMatch &m : matches)
+        {
+            refPts.push_back(entry.keypoints[m.trainIdx].pt);
+            framePts.push_back(features.keypoints[m.queryIdx].pt);
+        }
+
+        Mat inlierMask;
+        Mat H = findHomography(refPts, framePts, RANSAC, 5.0, inlierMask);
+        if (H.empty()) continue;
+
+        LibraryDetection detection;
+        detection.inliers = countNonZero(inlierMask);
+        if (detection.inliers < options.minInliers) continue;
+
+        std::vector<Point2f> pts = {Point2f(0, 0), Point2f(0, entry.size.height - 1),
+                                    Point2f(entry.size.width - 1, entry.size.height - 1),
+                                    Point2f(entry.size.width - 1, 0)};
+        perspectiveTransform(pts, detection.corners, H);
+        detection.index = static_cast<int>(i);
+        detection.name = entry.name;
+        detection.votes = voteCount;
+        detections.push_back(std::move(detection));
+    }
+
+    std::sort(detections.begin(), detections.end(), [](const LibraryDetection &a, const LibraryDetection &b) {
+        return a.inliers > b.inliers;
+    });
+    return detections;
+}
+
+void ReferenceLibrary::draw(Mat &frame, const std::vector<LibraryDetection> &detections)
+{
+    for (const LibraryDetection &d : detections)
+    {
+        std::vector<Point> polygon;
+        for (const Point2f &pt : d.corners) polygon.emplace_back(static_cast<int>(pt.x), static_cast<int>(pt.y));
+        polylines(frame, polygon, true, Scalar(0, 255, 0), 3);
+        putText(frame, d.name, polygon[0], FONT_HERSHEY_SIMPLEX, 0.8, Scalar(0, 255, 0), 2);
+    }
+}
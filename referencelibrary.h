@@ -0,0 +1,64 @@
+#ifndef REFERENCELIBRARY_H
+#define REFERENCELIBRARY_H
+
+#include "opencv2/opencv.hpp"
+#include "opencv2/features2d.hpp"
+#include "objecttracker.h"
+
+using namespace cv;
+
+struct LibraryOptions
+{
+    int tables = 12;         // LSH 哈希表数量
+    int keySize = 20;        // 哈希键位数
+    int multiProbeLevel = 2; // 多探针层级，0 为普通 LSH
+    float ratio = 0.8f;      // 最近邻比值检验阈值
+    int minVotes = 12;       // 一个参考至少获得这么多匹配才尝试估计单应性
+    int maxMatches = 200;    // 每个参考只取距离最小的前 k 个匹配估计单应性
+    int minInliers = 10;
+};
+
+struct LibraryDetection
+{
+    int index = -1;
+    std::string name;
+    std::vector<Point2f> corners;
+    int votes = 0;
+    int inliers = 0;
+};
+
+// 参考图库：预先计算每个参考的 ORB 关键点和描述符，并在全部二值描述符上建立 LSH 索引，
+// 每帧只需一次近邻查询即可得到各参考的匹配票数
+class ReferenceLibrary
+{
+public:
+    explicit ReferenceLibrary(const LibraryOptions &options = LibraryOptions());
+    ~ReferenceLibrary();
+
+    bool add(const std::string &name, const ImageFrame &image);  // 没有特征点时返回 false
+    void build();
+    bool isBuilt() const { return built; }
+    int size() const { return static_cast<int>(entries.size()); }
+    const std::string &name(int index) const { return entries[index].name; }
+
+    // 找出当前帧中出现的全部参考，按内点数从多到少排列
+    std::vector<LibraryDetection> detect(const TrackFeatures &features);
+    static void draw(Mat &frame, const std::vector<LibraryDetection> &detections);
+
+private:
+    struct Entry
+    {
+        std::string name;
+        Size size;
+        std::vector<KeyPoint> keypoints;
+        Mat descriptors;
+    };
+
+    LibraryOptions options;
+    Ptr<ORB> orb;
+    FlannBasedMatcher matcher;
+    std::vector<Entry> entries;
+    bool built = false;
+};
+
+#endif // REFERENCELIBRARY_H
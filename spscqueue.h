@@ -0,0 +1,54 @@
+#ifndef SPSCQUEUE_H
+#define SPSCQUEUE_H
+
+#include <atomic>
+#include <vector>
+
+// 单生产者单消费者的无锁环形队列，满时 push 失败而不是阻塞
+template <typename T>
+class SpscQueue
+{
+public:
+    explicit SpscQueue(size_t capacity) : buffer(capacity + 1) {}
+
+    bool push(T &&item)
+    {
+        size_t h = head.load(std::memory_order_relaxed);
+        size_t next = (h + 1) % buffer.size();
+        if (next == tail.load(std::memory_order_acquire)) return false;
+        buffer[h] = std::move(item);
+        head.store(next, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(T &item)
+    {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (t == head.load(std::memory_order_acquire)) return false;
+        item = std::move(buffer[t]);
+        tail.store((t + 1) % buffer.size(), std::memory_order_release);
+        return true;
+    }
+
+    // 取出队列中最新的一项，更早的项视为过期直接丢弃，返回丢弃的数量
+    int popLatest(T &item, bool &ok)
+    {
+        int dropped = 0;
+        ok = pop(item);
+        if (!ok) return 0;
+        T newer;
+        while (pop(newer))
+        {
+            item = std::move(newer);
+            dropped++;
+        }
+        return dropped;
+    }
+
+private:
+    std::vector<T> buffer;
+    alignas(64) std::atomic<size_t> head{0};
+    alignas(64) std::atomic<size_t> tail{0};
+};
+
+#endif // SPSCQUEUE_H
@@ -0,0 +1,144 @@
+#include "streamrunner.h"
+#include "batchpipeline.h"
+#include "detectorregistry.h"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QTextStream>
+#include <chrono>
+#include <iostream>
+
+static double percentile(std::vector<double> sorted, double p)
+{
+    if (sorted.empty()) return 0;
+    std::sort(sorted.begin(), sorted.end());
+    size_t k = std::min(sorted.size() - 1, static_cast<size_t>(p * (sorted.size() - 1) + 0.5));
+    return sorted[k];
+}
+
+static bool runSource(VideoCapture &cap, const QString &name, const StreamOptions &options, CascadeClassifier &detector)
+{
+    using Clock = std::chrono::steady_clock;
+    QDir out(options.outputDir);
+    int maxFrames = options.maxFrames > 0 ? options.maxFrames : (options.camera >= 0 ? 300 : 0);
+
+    // 每帧一行：帧号,延迟(ms),是否整帧扫描,人脸数
+    QFile csv(out.filePath(name + "_faces.csv"));
+    if (!csv.open(QIODevice::WriteOnly | QIODevice::Text))
+    {
+        std::cerr << "Error: Could not write " << csv.fileName().toStdString() << std::endl;
+        return false;
+    }
+    QTextStream stream(&csv);
+
+    VideoWriter writer;
+    double fps = cap.get(CAP_PROP_FPS);
+    FaceStreamDetector faceStream(options.face);
+    std::vector<double> latencies;
+    int fullScans = 0;
+
+    Mat frame, gray;
+    Clock::time_point start = Clock::now();
+    while (maxFrames == 0 || static_cast<int>(latencies.size()) < maxFrames)
+    {
+        cap >> frame;
+        if (frame.empty()) break;
+
+        // 延迟只统计检测本身，不含解码和写出
+        Clock::time_point begin = Clock::now();
+        cvtColor(frame, gray, COLOR_BGR2GRAY);
+        bool full = false;
+        std::vector<Rect> faces = faceStream.detect(detector, gray, &full);
+        double ms = std::chrono::duration<double, std::milli>(Clock::now() - begin).count();
+
+        latencies.push_back(ms);
+        fullScans += full;
+        stream << latencies.size() - 1 << ',' << ms << ',' << (full ? 1 : 0) << ',' << faces.size() << '\n';
+
+        if (options.saveVideo)
+        {
+            if (!writer.isOpened())
+            {
+                writer.open(out.filePath(name + "_faces.avi").toStdString(), VideoWriter::fourcc('M', 'J', 'P', 'G'),
+                            fps > 0 ? fps : 30.0, frame.size());
+            }
+            for (const Rect &face : faces) rectangle(frame, face, Scalar(0, 255, 0), 2);
+            writer << frame;
+        }
+    }
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    if (latencies.empty())
+    {
+        std::cerr << "Error: " << name.toStdString() << ": no frames read" << std::endl;
+        return false;
+    }
+
+    double mean = 0;
+    for (double ms : latencies) mean += ms;
+    mean /= latencies.size();
+    std::cout << name.toStdString() << ": " << latencies.size() << " frames, " << fullScans << " full scans, latency mean "
+              << mean << " ms, p50 " << percentile(latencies, 0.5) << " ms, p95 " << percentile(latencies, 0.95)
+              << " ms, max " << percentile(latencies, 1.0) << " ms, " << latencies.size() / seconds << " frames/s"
+              << std::endl;
+    return true;
+}
+
+int runFaceStream(const StreamOptions &options)
+{
+    DetectorRegistry::Lease detector = DetectorRegistry::instance().acquire(CASCADE_FRONTAL_FACE);
+    if (!detector)
+    {
+        std::cerr << "Error: Could not load face detector." << std::endl;
+        return 1;
+    }
+
+    bool ok = true;
+    if (options.camera >= 0)
+    {
+        VideoCapture cap(options.camera);
+        if (!cap.isOpened())
+        {
+            std::cerr << "Error: Could not open camera." << std::endl;
+            return 1;
+        }
+        ok &= runSource(cap, QString("camera%1").arg(options.camera), options, *detector);
+    }
+
+    // 与批处理相同的命名规则：不同目录或只有扩展名不同的同名视频，输出的 CSV 和视频互不覆盖
+    QStringList stems = BatchPipeline::outputStems(options.sources);
+    QDir out(options.outputDir);
+    for (int i = 0; i < options.sources.size(); i++)
+    {
+        const QString &path = options.sources[i];
+        if (stems[i].isEmpty())
+        {
+            std::cerr << "Error: " << path.toStdString() << " is listed more than once, skipped" << std::endl;
+            ok = false;
+            continue;
+        }
+        if (options.camera >= 0 && stems[i].compare(QString("camera%1").arg(options.camera), Qt::CaseInsensitive) == 0)
+        {
+            std::cerr << "Error: " << path.toStdString() << " would overwrite the camera output, skipped" << std::endl;
+            ok = false;
+            continue;
+        }
+        QString dir = QFileInfo(stems[i]).path();
+        if (dir != "." && !out.mkpath(dir))
+        {
+            std::cerr << "Error: Could not create output directory " << out.filePath(dir).toStdString() << std::endl;
+            ok = false;
+            continue;
+        }
+
+        VideoCapture cap(path.toStdString());
+        if (!cap.isOpened())
+        {
+            std::cerr << "Error: Could not open " << path.toStdString() << std::endl;
+            ok = false;
+            continue;
+        }
+        ok &= runSource(cap, stems[i], options, *detector);
+    }
+    return ok ? 0 : 1;
+}
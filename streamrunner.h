@@ -0,0 +1,20 @@
+#ifndef STREAMRUNNER_H
+#define STREAMRUNNER_H
+
+#include "facestream.h"
+#include <QStringList>
+
+struct StreamOptions
+{
+    QStringList sources;     // 视频文件
+    int camera = -1;         // 不小于0时改为读取该摄像头
+    int maxFrames = 0;       // 每个来源最多处理的帧数，0 表示读完为止（摄像头默认 300 帧）
+    QString outputDir;
+    bool saveVideo = true;   // 是否导出标注后的视频
+    FaceStreamOptions face;
+};
+
+// 逐帧运行 FaceStreamDetector，输出每帧延迟和整体吞吐量，返回进程退出码
+int runFaceStream(const StreamOptions &options);
+
+#endif // STREAMRUNNER_H
@@ -0,0 +1,274 @@
+#include "templatematcher.h"
+#include "threadpool.h"
+#include <atomic>
+#include <cfloat>
+
+bool TemplateMatcher::isMinBest(Method METHOD)
+{
+    return METHOD == Method::TM_SQDIFF || METHOD == Method::TM_SQDIFF_NORMED;
+}
+
+static bool better(double a, double b, bool minBest)
+{
+    return minBest ? a < b : a > b;
+}
+
+// 在得分图上取前 count 个峰值，每取一个就把其邻域置为最差值
+static std::vector<MatchCandidate> topPeaks(const Mat &result, bool minBest, int count, Size suppress)
+{
+    std::vector<MatchCandidate> peaks;
+    Mat scores = result.clone();
+    float worst = minBest ? FLT_MAX : -FLT_MAX;
+
+    for (int i = 0; i < count; i++)
+    {
+        double minVal, maxVal;
+        Point minLoc, maxLoc;
+        minMaxLoc(scores, &minVal, &maxVal, &minLoc, &maxLoc);
+
+        MatchCandidate c;
+        c.loc = minBest ? minLoc : maxLoc;
+        c.score = minBest ? minVal : maxVal;
+        if (c.score == worst) break;
+        peaks.push_back(c);
+
+        Rect area(c.loc.x - suppress.width, c.loc.y - suppress.height, 2 * suppress.width + 1, 2 * suppress.height + 1);
+        scores(area & Rect(0, 0, scores.cols, scores.rows)).setTo(Scalar(worst));
+    }
+    return peaks;
+}
+
+bool TemplateMatcher::pyramidLocate(const Mat &srcGray, const Mat &refGray, Method METHOD,
+                                    const PyramidOptions &options, MatchCandidate &best)
+{
+    bool minBest = isMinBest(METHOD);
+
+    // 构建金字塔，模板过小（边长不足8像素）时停止继续下采样
+    std::vector<Mat> srcPyr(1, srcGray), refPyr(1, refGray);
+    for (int i = 1; i < options.levels; i++)
+    {
+        const Mat &r = refPyr.back();
+        if (r.cols / 2 < 8 || r.rows / 2 < 8) break;
+
+        Mat srcDown, refDown;
+        pyrDown(srcPyr.back(), srcDown);
+        pyrDown(r, refDown);
+        srcPyr.push_back(srcDown);
+        refPyr.push_back(refDown);
+    }
+
+    // 最粗层：全图匹配并取多个候选
+    int top = static_cast<int>(srcPyr.size()) - 1;
+    Mat result;
+    matchTemplate(srcPyr[top], refPyr[top], result, METHOD);
+    std::vector<MatchCandidate> candidates = topPeaks(result, minBest, std::max(1, options.candidates),
+                                                      Size(refPyr[top].cols / 2, refPyr[top].rows / 2));
+
+    // 最粗层约占一半耗时，其余按层和候选平分
+    double done = top > 0 ? 0.5 : 1.0;
+    double step = top > 0 ? 0.5 / (top * std::max<size_t>(1, candidates.size())) : 0;
+    if (options.progress && !options.progress(done)) return false;
+
+    // 逐层细化：候选坐标放大两倍后，只在 ±margin 的窗口内重新匹配
+    int margin = std::max(1, options.margin);
+    for (int level = top - 1; level >= 0; level--)
+    {
+        const Mat &src = srcPyr[level];
+        const Mat &ref = refPyr[level];
+        int resCols = src.cols - ref.cols + 1;
+        int resRows = src.rows - ref.rows + 1;
+
+        std::vector<MatchCandidate> refined;
+        for (const MatchCandidate &c : candidates)
+        {
+            int x0 = std::max(0, 2 * c.loc.x - margin);
+            int y0 = std::max(0, 2 * c.loc.y - margin);
+            int x1 = std::min(resCols - 1, 2 * c.loc.x + margin);
+            int y1 = std::min(resRows - 1, 2 * c.loc.y + margin);
+            if (x0 > x1 || y0 > y1) continue;
+
+            Mat window = src(Rect(x0, y0, x1 - x0 + ref.cols, y1 - y0 + ref.rows));
+            Mat local;
+            matchTemplate(window, ref, local, METHOD);
+
+            double minVal, maxVal;
+            Point minLoc, maxLoc;
+            minMaxLoc(local, &minVal, &maxVal, &minLoc, &maxLoc);
+
+            MatchCandidate r;
+            r.loc = (minBest ? minLoc : maxLoc) + Point(x0, y0);
+            r.score = minBest ? minVal : maxVal;
+
+            // 不同候选收敛到同一位置时只保留一个
+            bool duplicate = false;
+            for (const MatchCandidate &other : refined)
+                duplicate |= other.loc == r.loc;
+            if (!duplicate) refined.push_back(r);
+
+            done += step;
+            if (options.progress && !options.progress(std::min(done, 1.0))) return false;
+        }
+
+        std::sort(refined.begin(), refined.end(), [minBest](const MatchCandidate &a, const MatchCandidate &b) {
+            return better(a.score, b.score, minBest);
+        });
+        candidates.swap(refined);
+    }
+
+    best = candidates.empty() ? MatchCandidate() : candidates.front();
+    return true;
+}
+
+bool TemplateMatcher::tiledMatch(const Mat &srcGray, const Mat &refGray, Mat &result, Method METHOD,
+                                 const TiledOptions &options)
+{
+    int resCols = srcGray.cols - refGray.cols + 1;
+    int resRows = srcGray.rows - refGray.rows + 1;
+    result.create(resRows, resCols, CV_32FC1);
+
+    ThreadPool &pool = ThreadPool::shared();
+    int threads = options.threads > 0 ? options.threads : pool.size() + 1;
+
+    // 默认每个线程分到两个条带，便于负载均衡
+    int tileRows = options.tileRows > 0 ? options.tileRows : (resRows + 2 * threads - 1) / (2 * threads);
+    tileRows = std::max(1, tileRows);
+    int tiles = (resRows + tileRows - 1) / tileRows;
+
+    std::atomic<int> finished{0};
+    std::atomic<bool> aborted{false};
+    pool.parallelFor(tiles, [&](int tile) {
+        if (aborted) return;
+        int r0 = tile * tileRows;
+        int r1 = std::min(resRows, r0 + tileRows);
+
+        // 条带的源图需要多出 模板高度-1 行，保证边界处的窗口完整
+        Mat srcStrip = srcGray.rowRange(r0, r1 + refGray.rows - 1);
+        Mat dstRows = result.rowRange(r0, r1);
+        matchTemplate(srcStrip, refGray, dstRows, METHOD);
+        if (options.progress && !options.progress(static_cast<double>(++finished) / tiles))
+            aborted = true;
+    }, threads);
+    return !aborted;
+}
+
+Mat TemplateMatcher::scoreMap(const Mat &result, Method METHOD)
+{
+    Mat scores;
+    switch (METHOD)
+    {
+    case Method::TM_SQDIFF_NORMED:
+        // 归一化方法本身有绝对意义，直接使用原始得分
+        scores = 1.0 - result;
+        break;
+    case Method::TM_CCORR_NORMED:
+    case Method::TM_CCOEFF_NORMED:
+        scores = result.clone();
+        break;
+    default:
+        // 非归一化方法只能按本图的最小/最大值归一化
+        normalize(result, scores, 0, 1, NORM_MINMAX, -1, Mat());
+        if (isMinBest(METHOD)) scores = 1.0 - scores;
+        break;
+    }
+    return scores;
+}
+
+// 并行扫描得分图，每个条带独立收集 3x3 邻域内的局部极大值
+class PeakScan : public ParallelLoopBody
+{
+public:
+    PeakScan(const Mat &scores, float threshold, int stripeRows, std::vector<std::vector<MatchCandidate>> &out)
+        : scores(scores), threshold(threshold), stripeRows(stripeRows), out(out) {}
+
+    void operator()(const Range &range) const override
+    {
+        for (int stripe = range.start; stripe < range.end; stripe++)
+        {
+            std::vector<MatchCandidate> &peaks = out[stripe];
+            int y0 = stripe * stripeRows;
+            int y1 = std::min(scores.rows, y0 + stripeRows);
+            for (int y = y0; y < y1; y++)
+            {
+                const float *prev = scores.ptr<float>(std::max(y - 1, 0));
+                const float *row = scores.ptr<float>(y);
+                const float *next = scores.ptr<float>(std::min(y + 1, scores.rows - 1));
+                for (int x = 0; x < scores.cols; x++)
+                {
+                    float v = row[x];
+                    if (v < threshold) continue;
+
+                    int xl = std::max(x - 1, 0), xr = std::min(x + 1, scores.cols - 1);
+                    // 平台区域只保留光栅顺序上的第一个点：对左、上方向要求严格大于
+                    bool isPeak = v > row[xl] || xl == x;
+                    isPeak = isPeak && v >= row[xr];
+                    isPeak = isPeak && (y == 0 || (v > prev[xl] && v > prev[x] && v > prev[xr]));
+                    isPeak = isPeak && (y == scores.rows - 1 || (v >= next[xl] && v >= next[x] && v >= next[xr]));
+                    if (isPeak) peaks.push_back({Point(x, y), v});
+                }
+            }
+        }
+    }
+
+private:
+    const Mat &scores;
+    float threshold;
+    int stripeRows;
+    std::vector<std::vector<MatchCandidate>> &out;
+};
+
+std::vector<MatchCandidate> TemplateMatcher::findAll(const Mat &scores, Size templSize, const MultiMatchOptions &options)
+{
+    CV_Assert(scores.type() == CV_32FC1);
+
+    // 1. 并行提取候选峰值
+    const int stripeRows = 64;
+    int stripes = (scores.rows + stripeRows - 1) / stripeRows;
+    std::vector<std::vector<MatchCandidate>> perStripe(stripes);
+    parallel_for_(Range(0, stripes), PeakScan(scores, static_cast<float>(options.threshold), stripeRows, perStripe));
+
+    std::vector<MatchCandidate> candidates;
+    for (std::vector<MatchCandidate> &peaks : perStripe)
+        candidates.insert(candidates.end(), peaks.begin(), peaks.end());
+    std::stable_sort(candidates.begin(), candidates.end(), [](const MatchCandidate &a, const MatchCandidate &b) {
+        return a.score > b.score;
+    });
+
+    // 2. 贪心非极大值抑制：已接受的框按模板大小分桶，
+    //    与候选框重叠的框只可能落在相邻的 3x3 个桶内
+    int cellW = std::max(1, templSize.width), cellH = std::max(1, templSize.height);
+    int gridCols = scores.cols / cellW + 1, gridRows = scores.rows / cellH + 1;
+    std::vector<std::vector<Point>> grid(gridCols * gridRows);
+    double boxArea = static_cast<double>(cellW) * cellH;
+
+    std::vector<MatchCandidate> matches;
+    for (const MatchCandidate &c : candidates)
+    {
+        int gx = c.loc.x / cellW, gy = c.loc.y / cellH;
+        bool suppressed = false;
+        for (int ny = std::max(gy - 1, 0); ny <= std::min(gy + 1, gridRows - 1) && !suppressed; ny++)
+        {
+            for (int nx = std::max(gx - 1, 0); nx <= std::min(gx + 1, gridCols - 1) && !suppressed; nx++)
+            {
+                for (const Point &p : grid[ny * gridCols + nx])
+                {
+                    int dx = std::abs(p.x - c.loc.x), dy = std::abs(p.y - c.loc.y);
+                    if (dx >= cellW || dy >= cellH) continue;
+
+                    // 同尺寸矩形的 IoU
+                    double inter = static_cast<double>(cellW - dx) * (cellH - dy);
+                    if (inter / (2 * boxArea - inter) > options.overlap)
+                    {
+                        suppressed = true;
+                        break;
+                    }
+                }
+            }
+        }
+        if (suppressed) continue;
+
+        grid[gy * gridCols + gx].push_back(c.loc);
+        matches.push_back(c);
+        if (options.maxMatches > 0 && static_cast<int>(matches.size()) >= options.maxMatches) break;
+    }
+    return matches;
+}
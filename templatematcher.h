@@ -0,0 +1,63 @@
+#ifndef TEMPLATEMATCHER_H
+#define TEMPLATEMATCHER_H
+
+#include "opencv2/opencv.hpp"
+#include "cvfunction.h"
+
+using namespace cv;
+
+struct PyramidOptions
+{
+    int levels = 3;      // 金字塔层数（含原始分辨率）
+    int candidates = 4;  // 每层保留的候选位置数
+    int margin = 4;      // 细化时在候选位置周围的搜索半径（像素）
+    ProgressCallback progress;  // 非空时逐层、逐个候选报告进度，返回 false 时中止
+};
+
+struct TiledOptions
+{
+    int threads = 0;   // 并行线程数，0 表示使用全部核心
+    int tileRows = 0;  // 每个条带输出的得分图行数，0 表示按线程数自动划分
+    ProgressCallback progress;  // 非空时逐条带报告进度，返回 false 时跳过剩余条带
+};
+
+struct MatchCandidate
+{
+    Point loc;
+    double score = 0;
+};
+
+struct MultiMatchOptions
+{
+    double threshold = 0.8;  // 得分阈值，得分已统一为 [0,1] 且越大越好
+    double overlap = 0.3;    // 两个匹配框的 IoU 超过该值时只保留得分高的一个
+    int maxMatches = 0;      // 返回数量上限，0 表示不限制
+};
+
+// templateSearch 的各种匹配策略，输入均为单通道灰度图，只负责定位，不做绘制
+class TemplateMatcher
+{
+public:
+    static bool isMinBest(Method METHOD);
+
+    // 由粗到细的金字塔匹配：最粗层全图匹配，较细层只在候选位置附近的小窗口内匹配。
+    // 进度回调要求中止时返回 false
+    static bool pyramidLocate(const Mat &srcGray, const Mat &refGray, Method METHOD,
+                              const PyramidOptions &options, MatchCandidate &best);
+
+    // 分条带并行计算得分图：源图按行切成相互重叠（模板高度-1）的条带，
+    // 每个条带的结果直接写入完整得分图的对应行。matchTemplate 按条带尺寸选择 DFT 分块，
+    // 拼接结果与整图计算只在浮点舍入范围内一致，不保证逐位相同；
+    // ObjectExtractBench template 检查按得分范围归一化的最大偏差不超过 1e-4，且最佳位置相同或并列最优。
+    // 进度回调要求中止时返回 false，此时 result 未填满
+    static bool tiledMatch(const Mat &srcGray, const Mat &refGray, Mat &result, Method METHOD,
+                           const TiledOptions &options);
+
+    // 把 matchTemplate 的结果转换成 [0,1] 且越大越好的得分图
+    static Mat scoreMap(const Mat &result, Method METHOD);
+
+    // 取出得分图中所有高于阈值的局部极大值并做非极大值抑制，按得分从高到低返回
+    static std::vector<MatchCandidate> findAll(const Mat &scores, Size templSize, const MultiMatchOptions &options);
+};
+
+#endif // TEMPLATEMATCHER_H
@@ -0,0 +1,113 @@
+#include "threadpool.h"
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <memory>
+
+ThreadPool::ThreadPool(int threads)
+{
+    if (threads <= 0) threads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    for (int i = 0; i < threads; i++)
+        workers.emplace_back(&ThreadPool::workerLoop, this);
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    cond.notify_all();
+    for (std::thread &t : workers) t.join();
+}
+
+ThreadPool &ThreadPool::shared()
+{
+    static ThreadPool pool;
+    return pool;
+}
+
+void ThreadPool::post(std::function<void()> task)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        tasks.push_back(std::move(task));
+    }
+    cond.notify_one();
+}
+
+void ThreadPool::workerLoop()
+{
+    for (;;)
+    {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            cond.wait(lock, [this] { return stopping || !tasks.empty(); });
+            if (stopping && tasks.empty()) return;
+            task = std::move(tasks.front());
+            tasks.pop_front();
+        }
+        task();
+    }
+}
+
+void ThreadPool::parallelFor(int count, const std::function<void(int)> &body, int maxThreads)
+{
+    if (count <= 0) return;
+    int threads = maxThreads > 0 ? maxThreads : size() + 1;
+    threads = std::min(threads, count);
+    if (threads <= 1)
+    {
+        for (int i = 0; i < count; i++) body(i);
+        return;
+    }
+
+    // 共享状态由 shared_ptr 持有，晚启动的任务在调用方返回后也能安全退出
+    struct State
+    {
+        std::atomic<int> next{0};
+        int count = 0;
+        int active = 0;
+        const std::function<void(int)> *body = nullptr;
+        std::exception_ptr error;
+        std::mutex mutex;
+        std::condition_variable done;
+    };
+    auto state = std::make_shared<State>();
+    state->count = count;
+    state->body = &body;
+
+    // 工作线程中逃出的异常会直接终止进程，先截住再交给调用线程
+    auto run = [](State &s) {
+        try
+        {
+            for (int i = s.next++; i < s.count; i = s.next++) (*s.body)(i);
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(s.mutex);
+            if (!s.error) s.error = std::current_exception();
+            s.next = s.count;
+        }
+    };
+
+    for (int i = 0; i < threads - 1; i++)
+    {
+        post([state, run] {
+            {
+                std::lock_guard<std::mutex> lock(state->mutex);
+                if (state->next >= state->count) return;
+                state->active++;
+            }
+            run(*state);
+            std::lock_guard<std::mutex> lock(state->mutex);
+            if (--state->active == 0) state->done.notify_all();
+        });
+    }
+
+    run(*state);
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->done.wait(lock, [&] { return state->active == 0; });
+    if (state->error) std::rethrow_exception(state->error);
+}
@@ -0,0 +1,38 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// 固定大小的工作线程池
+class ThreadPool
+{
+public:
+    explicit ThreadPool(int threads = 0);  // 0 表示硬件线程数
+    ~ThreadPool();
+
+    static ThreadPool &shared();
+
+    int size() const { return static_cast<int>(workers.size()); }
+    void post(std::function<void()> task);
+
+    // 把 [0, count) 分给最多 maxThreads 个线程执行，阻塞直到全部完成。
+    // 调用线程也参与执行，因此在池内线程中嵌套调用不会死锁。
+    // body 抛出的第一个异常在全部线程退出后由调用线程重新抛出，其余尚未开始的下标不再执行
+    void parallelFor(int count, const std::function<void(int)> &body, int maxThreads = 0);
+
+private:
+    void workerLoop();
+
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> tasks;
+    std::mutex mutex;
+    std::condition_variable cond;
+    bool stopping = false;
+};
+
+#endif // THREADPOOL_H
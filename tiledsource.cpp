@@ -0,0 +1,318 @@
+#include "tiledsource.h"
+#include "templatematcher.h"
+#include "preparedtemplate.h"
+#include "fftmatcher.h"
+#include "edgekernel.h"
+#include "contourscan.h"
+#include "threadpool.h"
+#include "traceprobe.h"
+#include <atomic>
+#include <cctype>
+#include <iostream>
+#include <mutex>
+
+TiledImageSource::TiledImageSource() {}
+
+TiledImageSource::~TiledImageSource()
+{
+    close();
+}
+
+// PNM 文件头：魔数、宽、高、最大值，以空白分隔，可夹带 # 注释；最大值之后的单个空白字符后即为像素
+bool TiledImageSource::parseHeader(QFile &file, Size &size, int &channels, qint64 &offset)
+{
+    QByteArray head = file.peek(1024);
+    if (head.size() < 2 || head[0] != 'P' || (head[1] != '5' && head[1] != '6')) return false;
+    channels = head[1] == '6' ? 3 : 1;
+
+    int pos = 2;
+    int values[3];
+    for (int &value : values)
+    {
+        for (;;)
+        {
+            while (pos < head.size() && isspace(static_cast<uchar>(head[pos]))) pos++;
+            if (pos < head.size() && head[pos] == '#')
+            {
+                while (pos < head.size() && head[pos] != '\n') pos++;
+                continue;
+            }
+            break;
+        }
+        if (pos >= head.size() || !isdigit(static_cast<uchar>(head[pos]))) return false;
+        value = 0;
+        while (pos < head.size() && isdigit(static_cast<uchar>(head[pos])))
+        {
+            if (value > 100000000) return false;
+            value = value * 10 + (head[pos++] - '0');
+        }
+    }
+    if (pos >= head.size() || !isspace(static_cast<uchar>(head[pos]))) return false;
+
+    // 只支持 8 位像素，16 位 PNM 需要字节序转换，不能直接引用映射区
+    if (values[0] <= 0 || values[1] <= 0 || values[2] <= 0 || values[2] > 255) return false;
+    size = Size(values[0], values[1]);
+    offset = pos + 1;
+    return true;
+}
+
+bool TiledImageSource::probe(const QString &path, Size &size, int &channels)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) return false;
+    qint64 offset;
+    return parseHeader(file, size, channels, offset);
+}
+
+bool TiledImageSource::open(const QString &path)
+{
+    close();
+    file.setFileName(path);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        std::cerr << "Error: Could not open " << path.toStdString() << std::endl;
+        return false;
+    }
+
+    qint64 offset;
+    if (!parseHeader(file, imageSize, cn, offset))
+    {
+        std::cerr << "Error: " << path.toStdString() << " is not an 8-bit binary PPM/PGM" << std::endl;
+        close();
+        return false;
+    }
+    return mapPixels(offset);
+}
+
+bool TiledImageSource::openRaw(const QString &path, Size size, int channels, qint64 offset)
+{
+    close();
+    CV_Assert(channels == 1 || channels == 3);
+    file.setFileName(path);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        std::cerr << "Error: Could not open " << path.toStdString() << std::endl;
+        return false;
+    }
+    imageSize = size;
+    cn = channels;
+    return mapPixels(offset);
+}
+
+bool TiledImageSource::mapPixels(qint64 offset)
+{
+    qint64 bytes = static_cast<qint64>(imageSize.width) * imageSize.height * cn;
+    if (file.size() < offset + bytes)
+    {
+        std::cerr << "Error: " << file.fileName().toStdString() << " is truncated" << std::endl;
+        close();
+        return false;
+    }
+
+    // 从文件开头映射，像素区的偏移不必按页对齐
+    mapped = file.map(0, offset + bytes);
+    if (!mapped)
+    {
+        std::cerr << "Error: Could not map " << file.fileName().toStdString() << std::endl;
+        close();
+        return false;
+    }
+    pixels = mapped + offset;
+    return true;
+}
+
+void TiledImageSource::close()
+{
+    if (mapped) file.unmap(mapped);
+    mapped = nullptr;
+    pixels = nullptr;
+    if (file.isOpen()) file.close();
+    imageSize = Size();
+    cn = 0;
+}
+
+Mat TiledImageSource::view(Rect roi) const
+{
+    CV_Assert(isOpen() && (roi & Rect(Point(0, 0), imageSize)) == roi);
+    size_t step = static_cast<size_t>(imageSize.width) * cn;
+    const uchar *origin = pixels + roi.y * step + static_cast<size_t>(roi.x) * cn;
+    // 映射区是只读的，Mat 只是借用指针，调用者不能写入
+    return Mat(roi.height, roi.width, CV_8UC(cn), const_cast<uchar *>(origin), step);
+}
+
+Mat TiledImageSource::readRGB(Rect roi) const
+{
+    Mat region = view(roi), rgb;
+    if (cn == 3)
+        region.copyTo(rgb);
+    else
+        cvtColor(region, rgb, COLOR_GRAY2RGB);
+    return rgb;
+}
+
+Mat TiledImageSource::overview(int maxSide) const
+{
+    CV_Assert(isOpen());
+    double scale = std::min(1.0, static_cast<double>(maxSide) / std::max(imageSize.width, imageSize.height));
+    Size outSize(std::max(1, cvRound(imageSize.width * scale)), std::max(1, cvRound(imageSize.height * scale)));
+
+    // 每次缩放一个源行条带，INTER_AREA 直接读映射区，不生成整图副本
+    Mat out(outSize, CV_8UC(cn));
+    const int band = 16;
+    for (int y0 = 0; y0 < outSize.height; y0 += band)
+    {
+        int y1 = std::min(outSize.height, y0 + band);
+        int sy0 = static_cast<int>(static_cast<int64>(y0) * imageSize.height / outSize.height);
+        int sy1 = static_cast<int>(static_cast<int64>(y1) * imageSize.height / outSize.height);
+        Mat rows = out.rowRange(y0, y1);
+        resize(view(Rect(0, sy0, imageSize.width, sy1 - sy0)), rows, rows.size(), 0, 0, INTER_AREA);
+    }
+    if (cn == 1) cvtColor(out, out, COLOR_GRAY2RGB);
+    return out;
+}
+
+// 各块完成时报告进度，回调要求中止后其余的块直接跳过
+class TileProgress
+{
+public:
+    TileProgress(const ProgressCallback &callback, int total) : callback(callback), total(total) {}
+
+    bool aborted() const { return stop; }
+    void tileDone()
+    {
+        if (callback && !callback(static_cast<double>(++finished) / total)) stop = true;
+    }
+
+private:
+    const ProgressCallback &callback;
+    int total;
+    std::atomic<int> finished{0};
+    std::atomic<bool> stop{false};
+};
+
+bool TiledProcessor::locate(const TiledImageSource &src, const PreparedTemplate &ref, Method METHOD,
+                            const TiledSourceOptions &options, MatchCandidate &best)
+{
+    TRACE_SCOPE("tiled.locate");
+    Size templ = ref.size(), image = src.size();
+    if (!src.isOpen() || ref.empty() || templ.width > image.width || templ.height > image.height) return false;
+
+    Rect result(0, 0, image.width - templ.width + 1, image.height - templ.height + 1);
+    int tile = std::max(64, options.tileSize);
+    int tileRows = (result.height + tile - 1) / tile;
+    int tileCols = (result.width + tile - 1) / tile;
+    bool minBest = TemplateMatcher::isMinBest(METHOD);
+    TileProgress progress(options.progress, tileRows * tileCols);
+
+    std::mutex mutex;
+    bool found = false;
+    ThreadPool::shared().parallelFor(tileRows, [&](int r) {
+        FftMatcher matcher;
+        MatchCandidate rowBest;
+        bool rowFound = false;
+        for (int x = 0; x < result.width && !progress.aborted(); x += tile)
+        {
+            TRACE_SCOPE("tiled.matchTile");
+            Rect out = Rect(x, r * tile, tile, tile) & result;
+            Size window(out.width + templ.width - 1, out.height + templ.height - 1);
+            if (matcher.empty())
+                matcher.reset(ref, window);
+            else if (matcher.sourceSize() != window)
+                matcher.resize(window);
+
+            // 得分未做 NORM_MINMAX 归一化，块之间可以直接比较
+            double minVal, maxVal;
+            Point minLoc, maxLoc;
+            minMaxLoc(matcher.match(src.view(Rect(out.tl(), window)), METHOD), &minVal, &maxVal, &minLoc, &maxLoc);
+            double score = minBest ? minVal : maxVal;
+            if (!rowFound || (minBest ? score < rowBest.score : score > rowBest.score))
+            {
+                rowBest.loc = (minBest ? minLoc : maxLoc) + out.tl();
+                rowBest.score = score;
+                rowFound = true;
+            }
+            progress.tileDone();
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (rowFound && (!found || (minBest ? rowBest.score < best.score : rowBest.score > best.score)))
+        {
+            best = rowBest;
+            found = true;
+        }
+    }, options.threads);
+    return found && !progress.aborted();
+}
+
+bool TiledProcessor::edgeMap(const TiledImageSource &src, const QString &edgePath, const TiledSourceOptions &options,
+                             std::vector<Point> &largest, Rect &bbox)
+{
+    TRACE_SCOPE("tiled.edgeMap");
+    if (!src.isOpen()) return false;
+    Size image = src.size();
+
+    // 输出为 PGM，文件先扩展到完整大小再映射，各块直接写入对应位置，由系统按页写回
+    QFile out(edgePath);
+    if (!out.open(QIODevice::ReadWrite | QIODevice::Truncate))
+    {
+        std::cerr << "Error: Could not write " << edgePath.toStdString() << std::endl;
+        return false;
+    }
+    QByteArray header = QString("P5\n%1 %2\n255\n").arg(image.width).arg(image.height).toLatin1();
+    qint64 bytes = header.size() + static_cast<qint64>(image.width) * image.height;
+    if (out.write(header) != header.size() || !out.resize(bytes))
+    {
+        std::cerr << "Error: Could not write " << edgePath.toStdString() << std::endl;
+        return false;
+    }
+    uchar *mapped = out.map(0, bytes);
+    if (!mapped)
+    {
+        std::cerr << "Error: Could not map " << edgePath.toStdString() << std::endl;
+        return false;
+    }
+    Mat edges(image.height, image.width, CV_8UC1, mapped + header.size());
+
+    int tile = std::max(64, options.tileSize);
+    int margin = std::max(2, options.edgeMargin);  // Sobel 和非极大值抑制各需要一个像素
+    int tileRows = (image.height + tile - 1) / tile;
+    int tileCols = (image.width + tile - 1) / tile;
+    Rect bounds(Point(0, 0), image);
+    TileProgress progress(options.progress, tileRows * tileCols);
+
+    std::mutex mutex;
+    double bestArea = -1;
+    ThreadPool::shared().parallelFor(tileRows, [&](int r) {
+        Mat tileEdges;
+        for (int x = 0; x < image.width && !progress.aborted(); x += tile)
+        {
+            TRACE_SCOPE("tiled.edgeTile");
+            Rect core = Rect(x, r * tile, tile, tile) & bounds;
+            Rect context = Rect(core.x - margin, core.y - margin, core.width + 2 * margin, core.height + 2 * margin) & bounds;
+
+            // 融合实现直接读取映射区：PPM 块在条带内转为灰度，PGM 块本身就是灰度
+            EdgeKernel::detect(src.view(context), tileEdges, 50, 150, 1);
+            Mat coreEdges = tileEdges(core - context.tl());
+            coreEdges.copyTo(edges(core));
+
+            std::vector<Point> contour;
+            double area = 0;
+            Rect box;
+            bool hasContour = ContourScan::largestExternal(coreEdges, contour, &area, &box);
+            progress.tileDone();
+            if (!hasContour) continue;
+
+            std::lock_guard<std::mutex> lock(mutex);
+            if (area > bestArea)
+            {
+                bestArea = area;
+                for (Point &p : contour) p += core.tl();
+                largest.swap(contour);
+                bbox = box + core.tl();
+            }
+        }
+    }, options.threads);
+
+    out.unmap(mapped);
+    return bestArea >= 0 && !progress.aborted();
+}
@@ -0,0 +1,74 @@
+#ifndef TILEDSOURCE_H
+#define TILEDSOURCE_H
+
+#include "opencv2/opencv.hpp"
+#include "cvfunction.h"
+#include <QFile>
+#include <QString>
+
+using namespace cv;
+
+struct TiledSourceOptions
+{
+    int tileSize = 1024;  // 每块输出区域的边长，决定每个线程的内存占用
+    int threads = 0;      // 并行线程数，0 表示使用全部核心
+    int edgeMargin = 16;  // 边缘检测时每块向外扩展的像素，滞后阈值只能在这段距离内跨过块边界延续
+    ProgressCallback progress;  // 非空时逐块报告进度，返回 false 时跳过剩余的块，操作返回 false
+};
+
+// 超大图像的只读分块数据源：把未压缩的 PPM(P6)/PGM(P5) 或无文件头的原始像素文件映射到内存，
+// view() 直接引用映射区，操作只触及的块才会由系统读入，进程本身不持有整图的副本。
+// PPM 的像素本身就是 RGB 顺序，读取时不需要再转换
+class TiledImageSource
+{
+public:
+    TiledImageSource();
+    ~TiledImageSource();
+    TiledImageSource(const TiledImageSource &) = delete;
+    TiledImageSource &operator=(const TiledImageSource &) = delete;
+
+    bool open(const QString &path);  // 8 位二进制 PPM/PGM
+    bool openRaw(const QString &path, Size size, int channels, qint64 offset = 0);  // RGB 或灰度的原始像素
+    void close();
+
+    bool isOpen() const { return pixels != nullptr; }
+    Size size() const { return imageSize; }
+    int channels() const { return cn; }
+    QString path() const { return file.fileName(); }
+
+    Mat view(Rect roi) const;                // 映射区的只读视图（CV_8UC3 为 RGB，CV_8UC1 为灰度）
+    Mat readRGB(Rect roi) const;             // 复制为 RGB 图像
+    Mat overview(int maxSide) const;         // 长边缩小到 maxSide 的 RGB 预览图，按行条带逐段缩放
+
+    // 只读取文件头，判断能否分块打开并取得尺寸
+    static bool probe(const QString &path, Size &size, int &channels);
+
+private:
+    static bool parseHeader(QFile &file, Size &size, int &channels, qint64 &offset);
+    bool mapPixels(qint64 offset);
+
+    QFile file;
+    uchar *mapped = nullptr;
+    const uchar *pixels = nullptr;
+    Size imageSize;
+    int cn = 0;
+};
+
+// 在分块数据源上运行的操作，每个线程一次只处理一块，内存占用与整图大小无关
+class TiledProcessor
+{
+public:
+    // 分块模板匹配：每块输出区域向右下扩展模板尺寸减一后匹配，每块覆盖的窗口与整图相同，
+    // 但 DFT 尺寸按块选择，得分与整图 matchTemplate 只在浮点舍入范围内一致，不保证逐位相同；
+    // 最优值接近并列时选中的位置可能不同。同一行的块尺寸一致，行内复用 FftMatcher 的 DFT 计划和缓冲
+    static bool locate(const TiledImageSource &src, const PreparedTemplate &ref, Method METHOD,
+                       const TiledSourceOptions &options, MatchCandidate &best);
+
+    // 分块边缘检测：边缘图逐块写入映射的 PGM 文件 edgePath；同时返回各块内面积最大的外轮廓中最大的一个
+    // （原始分辨率坐标），跨越块边界的轮廓会被分成几段。结果是整图 Canny 的近似：
+    // 滞后阈值只在 edgeMargin 范围内跨块延续，靠强边缘在更远处连通的弱边缘在块边界附近会丢失
+    static bool edgeMap(const TiledImageSource &src, const QString &edgePath, const TiledSourceOptions &options,
+                        std::vector<Point> &largest, Rect &bbox);
+};
+
+#endif // TILEDSOURCE_H
@@ -0,0 +1,203 @@
+#include "traceprobe.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <mutex>
+
+namespace {
+
+// 事件字段都是原子量：写入线程只做 relaxed 存储，读取方按 head 前后两次快照丢弃被覆盖的事件
+struct TraceEvent
+{
+    std::atomic<const char *> name{nullptr};
+    std::atomic<int64_t> start{0};
+    std::atomic<int64_t> end{0};
+};
+
+struct TraceRing
+{
+    static const uint64_t CAPACITY = 1 << 14;  // 必须是 2 的幂
+
+    int tid = 0;
+    std::string threadName;                // 受 ringsMutex 保护
+    std::atomic<bool> inUse{true};         // 线程退出后置为 false，由新线程复用
+    std::atomic<uint64_t> head{0};         // 只由所属线程递增
+    std::unique_ptr<TraceEvent[]> events{new TraceEvent[CAPACITY]};
+};
+
+struct Snapshot
+{
+    int tid;
+    const char *name;
+    int64_t start, end;
+};
+
+std::mutex ringsMutex;
+std::vector<std::unique_ptr<TraceRing>> rings;  // 线程退出后仍保留，导出时可读
+std::atomic<int64_t> clearedAt{0};
+
+// 线程退出时归还缓冲，线程池扩缩不会让缓冲无限增长
+struct RingHolder
+{
+    TraceRing *ring = nullptr;
+    ~RingHolder()
+    {
+        if (ring) ring->inUse.store(false, std::memory_order_release);
+    }
+};
+
+thread_local RingHolder localRing;
+thread_local const char *localName = nullptr;  // 缓冲在第一次记录时才分配，线程名先保存在这里
+
+TraceRing *threadRing()
+{
+    if (localRing.ring) return localRing.ring;
+
+    std::lock_guard<std::mutex> lock(ringsMutex);
+    for (const std::unique_ptr<TraceRing> &ring : rings)
+    {
+        bool idle = false;
+        if (ring->inUse.compare_exchange_strong(idle, true))
+        {
+            ring->threadName = localName ? localName : "";
+            localRing.ring = ring.get();
+            return localRing.ring;
+        }
+    }
+    rings.push_back(std::make_unique<TraceRing>());
+    rings.back()->tid = static_cast<int>(rings.size());
+    rings.back()->threadName = localName ? localName : "";
+    localRing.ring = rings.back().get();
+    return localRing.ring;
+}
+
+// 复制全部线程中 clear() 之后开始、结束时间不早于 since 的事件，threads 非空时同时取出线程名
+std::vector<Snapshot> collect(int64_t since, std::map<int, std::string> *threads = nullptr)
+{
+    std::vector<Snapshot> events;
+    int64_t cleared = clearedAt.load(std::memory_order_relaxed);
+
+    std::lock_guard<std::mutex> lock(ringsMutex);
+    for (const std::unique_ptr<TraceRing> &ring : rings)
+    {
+        uint64_t end = ring->head.load(std::memory_order_acquire);
+        uint64_t begin = end > TraceRing::CAPACITY ? end - TraceRing::CAPACITY : 0;
+        size_t first = events.size();
+        if (threads) (*threads)[ring->tid] = ring->threadName;
+        for (uint64_t i = begin; i < end; i++)
+        {
+            const TraceEvent &e = ring->events[i & (TraceRing::CAPACITY - 1)];
+            events.push_back({ring->tid, e.name.load(std::memory_order_relaxed),
+                              e.start.load(std::memory_order_relaxed), e.end.load(std::memory_order_relaxed)});
+        }
+
+        // 复制期间写入线程可能已经绕回覆盖了最旧的事件，正在写的下一个位置也算在内
+        uint64_t after = ring->head.load(std::memory_order_acquire) + 1;
+        size_t overwritten = after > begin + TraceRing::CAPACITY ? after - begin - TraceRing::CAPACITY : 0;
+        events.erase(events.begin() + first, events.begin() + first + std::min(overwritten, events.size() - first));
+    }
+
+    events.erase(std::remove_if(events.begin(), events.end(), [since, cleared](const Snapshot &e) {
+                     return !e.name || e.start < cleared || e.end < since;
+                 }), events.end());
+    return events;
+}
+
+} // namespace
+
+void TraceProbe::setEnabled(bool on)
+{
+    active.store(on, std::memory_order_relaxed);
+}
+
+void TraceProbe::clear()
+{
+    clearedAt.store(now(), std::memory_order_relaxed);
+}
+
+int64_t TraceProbe::now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void TraceProbe::record(const char *name, int64_t start, int64_t end)
+{
+    TraceRing *ring = threadRing();
+    uint64_t head = ring->head.load(std::memory_order_relaxed);
+    TraceEvent &e = ring->events[head & (TraceRing::CAPACITY - 1)];
+    e.name.store(name, std::memory_order_relaxed);
+    e.start.store(start, std::memory_order_relaxed);
+    e.end.store(end, std::memory_order_relaxed);
+    ring->head.store(head + 1, std::memory_order_release);
+}
+
+void TraceProbe::setThreadName(const char *name)
+{
+    localName = name;
+    if (!localRing.ring) return;
+    std::lock_guard<std::mutex> lock(ringsMutex);
+    localRing.ring->threadName = name;
+}
+
+bool TraceProbe::exportChrome(const std::string &path)
+{
+    std::map<int, std::string> threads;
+    std::vector<Snapshot> events = collect(0, &threads);
+    std::ofstream out(path);
+    if (!out) return false;
+
+    int64_t origin = events.empty() ? 0 : events.front().start;
+    for (const Snapshot &e : events) origin = std::min(origin, e.start);
+
+    // 时间单位为微秒；每个线程先输出一条 thread_name 元数据
+    out << std::fixed << std::setprecision(3) << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first = true;
+    for (const auto &thread : threads)
+    {
+        std::string name = thread.second.empty() ? "thread " + std::to_string(thread.first) : thread.second;
+        out << (first ? "" : ",") << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << thread.first
+            << ",\"args\":{\"name\":\"" << name << "\"}}";
+        first = false;
+    }
+    for (const Snapshot &e : events)
+    {
+        out << (first ? "" : ",") << "\n{\"name\":\"" << e.name << "\",\"cat\":\"objectextract\",\"ph\":\"X\",\"pid\":1,\"tid\":"
+            << e.tid << ",\"ts\":" << (e.start - origin) / 1000.0 << ",\"dur\":" << (e.end - e.start) / 1000.0 << "}";
+        first = false;
+    }
+    out << "\n]}\n";
+    return static_cast<bool>(out);
+}
+
+std::vector<TraceStage> TraceProbe::stages(double windowMs)
+{
+    std::vector<Snapshot> events = collect(now() - static_cast<int64_t>(windowMs * 1e6));
+    std::sort(events.begin(), events.end(), [](const Snapshot &a, const Snapshot &b) { return a.end < b.end; });
+
+    std::map<std::string, TraceStage> byName;
+    for (const Snapshot &e : events)
+    {
+        TraceStage &stage = byName[e.name];
+        double ms = (e.end - e.start) / 1e6;
+        stage.count++;
+        stage.lastMs = ms;
+        stage.totalMs += ms;
+        stage.maxMs = std::max(stage.maxMs, ms);
+    }
+
+    std::vector<TraceStage> result;
+    for (auto &entry : byName)
+    {
+        entry.second.name = entry.first;
+        entry.second.meanMs = entry.second.totalMs / entry.second.count;
+        result.push_back(entry.second);
+    }
+    std::sort(result.begin(), result.end(), [](const TraceStage &a, const TraceStage &b) {
+        return a.totalMs > b.totalMs;
+    });
+    return result;
+}
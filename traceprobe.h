@@ -0,0 +1,85 @@
+#ifndef TRACEPROBE_H
+#define TRACEPROBE_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct TraceStage
+{
+    std::string name;
+    int count = 0;        // 统计窗口内的次数
+    double lastMs = 0;    // 最近一次的耗时
+    double meanMs = 0;
+    double maxMs = 0;
+    double totalMs = 0;
+};
+
+// 热路径计时探针。每个线程写自己的环形缓冲，写入不加锁；关闭时每个探针只有一次原子读和分支。
+// 编译时定义 OBJECTEXTRACT_NO_TRACE 则探针完全去掉
+class TraceProbe
+{
+public:
+    static bool enabled() { return active.load(std::memory_order_relaxed); }
+    static void setEnabled(bool on);
+    static void clear();  // 丢弃此前记录的事件
+
+    static int64_t now();  // 纳秒
+    static void record(const char *name, int64_t start, int64_t end);  // name 须为字符串字面量
+    static void setThreadName(const char *name);  // 导出时显示的线程名，须为字符串字面量
+
+    static bool exportChrome(const std::string &path);          // Chrome trace-event JSON，可在 Perfetto 或 chrome://tracing 打开
+    static std::vector<TraceStage> stages(double windowMs = 1000);  // 最近 windowMs 内各阶段的耗时，按总耗时降序
+
+private:
+    static inline std::atomic<bool> active{false};
+};
+
+// 记录所在作用域的耗时；next() 结束当前阶段并开始下一阶段，用于顺序执行的多个步骤，stop() 提前结束
+class TraceScope
+{
+public:
+    explicit TraceScope(const char *name)
+        : name(TraceProbe::enabled() ? name : nullptr), start(this->name ? TraceProbe::now() : 0) {}
+    ~TraceScope() { stop(); }
+    TraceScope(const TraceScope &) = delete;
+    TraceScope &operator=(const TraceScope &) = delete;
+
+    int64_t stop()
+    {
+        if (!name) return 0;
+        int64_t end = TraceProbe::now();
+        TraceProbe::record(name, start, end);
+        name = nullptr;
+        return end;
+    }
+
+    void next(const char *stage)
+    {
+        int64_t t = stop();
+        name = TraceProbe::enabled() ? stage : nullptr;
+        start = name ? (t ? t : TraceProbe::now()) : 0;
+    }
+
+private:
+    const char *name;
+    int64_t start;
+};
+
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+
+#ifdef OBJECTEXTRACT_NO_TRACE
+#define TRACE_SCOPE(name) ((void)0)
+#define TRACE_STAGE(var, name) ((void)0)
+#define TRACE_NEXT(var, name) ((void)0)
+#define TRACE_END(var) ((void)0)
+#else
+#define TRACE_SCOPE(name) TraceScope TRACE_CONCAT(traceScope_, __LINE__)(name)
+#define TRACE_STAGE(var, name) TraceScope var(name)
+#define TRACE_NEXT(var, name) var.next(name)
+#define TRACE_END(var) ((void)var.stop())
+#endif
+
+#endif // TRACEPROBE_H
@@ -0,0 +1,291 @@
+#include "trackpipeline.h"
+#include "traceprobe.h"
+#include <chrono>
+
+// 队列为空时短暂休眠，避免空转占满CPU
+static void idle()
+{
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+}
+
+TrackPipeline::TrackPipeline(QObject *parent)
+    : QObject(parent)
+{
+}
+
+TrackPipeline::~TrackPipeline()
+{
+    stop();
+}
+
+bool TrackPipeline::start(const ImageFrame &ref, int camera, const TrackerOptions &options)
+{
+    if (!reclaim()) return false;
+
+    library.reset();
+    faceStream.reset();
+    faceDetector = DetectorRegistry::Lease();
+    tracker = std::make_unique<ObjectTracker>(ref, options);
+    if (!tracker->valid())
+    {
+        emit failed(tr("参考图中没有检测到特征点"));
+        return false;
+    }
+
+    launch(camera);
+    return true;
+}
+
+bool TrackPipeline::start(std::shared_ptr<ReferenceLibrary> library, int camera)
+{
+    if (!reclaim()) return false;
+    if (!library || library->size() == 0)
+    {
+        emit failed(tr("参考图库为空"));
+        return false;
+    }
+
+    tracker.reset();
+    faceStream.reset();
+    faceDetector = DetectorRegistry::Lease();
+    this->library = std::move(library);
+    if (!this->library->isBuilt()) this->library->build();  // 加载图库时已经建好索引，不再重复训练
+    frameOrb = ORB::create();
+
+    launch(camera);
+    return true;
+}
+
+bool TrackPipeline::start(const FaceStreamOptions &options, int camera)
+{
+    if (!reclaim()) return false;
+
+    faceDetector = DetectorRegistry::instance().acquire(CASCADE_FRONTAL_FACE);
+    if (!faceDetector)
+    {
+        emit failed(tr("无法加载人脸检测模型"));
+        return false;
+    }
+
+    tracker.reset();
+    library.reset();
+    faceStream = std::make_unique<FaceStreamDetector>(options);
+
+    launch(camera);
+    return true;
+}
+
+// 采集线程打不开摄像头时会自行把 running 置为 false 并发出 failed，其余线程随后退出，
+// 但要等界面排队的 stop() 才被 join。在此之前再次启动时先回收这些线程，
+// 否则给仍可 join 的 std::thread 赋值会调用 std::terminate
+bool TrackPipeline::reclaim()
+{
+    if (running) return false;
+    if (joinThreads()) emit finished();
+    return true;
+}
+
+bool TrackPipeline::joinThreads()
+{
+    bool joined = false;
+    for (std::thread &t : threads)
+    {
+        if (!t.joinable()) continue;
+        t.join();
+        joined = true;
+    }
+    return joined;
+}
+
+void TrackPipeline::launch(int camera)
+{
+    joinThreads();
+
+    // 清空上一次运行残留的帧
+    Frame stale;
+    while (captured.pop(stale)) {}
+    while (featured.pop(stale)) {}
+    while (matched.pop(stale)) {}
+
+    dropped = 0;
+    detections = 0;
+    running = true;
+    threads[0] = std::thread(&TrackPipeline::captureStage, this, camera);
+    threads[1] = std::thread(&TrackPipeline::featureStage, this);
+    threads[2] = std::thread(&TrackPipeline::matchStage, this);
+    threads[3] = std::thread(&TrackPipeline::displayStage, this);
+}
+
+void TrackPipeline::stop()
+{
+    running = false;
+    if (joinThreads()) emit finished();
+}
+
+QImage TrackPipeline::takeFrame()
+{
+    std::lock_guard<std::mutex> lock(frameMutex);
+    framePending = false;
+    return latestFrame;
+}
+
+void TrackPipeline::captureStage(int camera)
+{
+    TraceProbe::setThreadName("track capture");
+    // 初始化摄像头
+    VideoCapture cap(camera);
+    if (!cap.isOpened())
+    {
+        running = false;
+        emit failed(tr("无法打开摄像头"));
+        return;
+    }
+
+    int index = 0;
+    while (running)
+    {
+        Frame frame;
+        TRACE_STAGE(stage, "track.capture");
+        cap >> frame.image;
+        TRACE_END(stage);
+        if (frame.image.empty())
+        {
+            running = false;
+            emit failed(tr("摄像头读取失败"));
+            break;
+        }
+        frame.index = index++;
+        frame.captureTime = std::chrono::steady_clock::now();
+
+        // 下游来不及处理时丢弃新帧，采集线程从不等待
+        if (!captured.push(std::move(frame))) dropped++;
+    }
+    cap.release();
+}
+
+void TrackPipeline::featureStage()
+{
+    TraceProbe::setThreadName("track feature");
+    Frame frame;
+    while (running)
+    {
+        bool ok;
+        dropped += captured.popLatest(frame, ok);
+        if (!ok)
+        {
+            idle();
+            continue;
+        }
+
+        // 光流跟踪稳定时跳过 ORB，只准备灰度图
+        TRACE_STAGE(stage, "track.gray");
+        cvtColor(frame.image, frame.gray, COLOR_BGR2GRAY);
+        TRACE_END(stage);
+        frame.features = TrackFeatures();
+        // 人脸模式只需要灰度图
+        if (library)
+            frameOrb->detectAndCompute(frame.gray, Mat(), frame.features.keypoints, frame.features.descriptors);
+        else if (tracker && tracker->needsDetection())
+            tracker->extract(frame.gray, frame.features);
+        if (!featured.push(std::move(frame))) dropped++;
+    }
+}
+
+void TrackPipeline::matchStage()
+{
+    TraceProbe::setThreadName("track match");
+    Frame frame;
+    while (running)
+    {
+        bool ok;
+        dropped += featured.popLatest(frame, ok);
+        if (!ok)
+        {
+            idle();
+            continue;
+        }
+
+        if (faceStream)
+        {
+            TRACE_SCOPE("track.faces");
+            frame.result = TrackResult();
+            frame.faces = faceStream->detect(*faceDetector, frame.gray, &frame.result.detected);
+            frame.result.found = !frame.faces.empty();
+        }
+        else if (library)
+        {
+            TRACE_SCOPE("track.library");
+            frame.detections = library->detect(frame.features);
+            frame.result = TrackResult();
+            frame.result.detected = true;
+            frame.result.found = !frame.detections.empty();
+        }
+        else
+        {
+            frame.result = tracker->track(frame.gray, frame.features);
+        }
+        if (frame.result.detected) detections++;
+        frame.features = TrackFeatures();
+        frame.gray.release();
+        if (!matched.push(std::move(frame))) dropped++;
+    }
+}
+
+void TrackPipeline::displayStage()
+{
+    TraceProbe::setThreadName("track display");
+    using Clock = std::chrono::steady_clock;
+    Clock::time_point lastReport = Clock::now();
+    int framesSinceReport = 0, frames = 0;
+    double latencySum = 0;  // 采集到显示的延迟，按统计区间求平均
+
+    Frame frame;
+    while (running)
+    {
+        bool ok;
+        dropped += matched.popLatest(frame, ok);
+        if (!ok)
+        {
+            idle();
+            continue;
+        }
+
+        TRACE_STAGE(stage, "track.draw");
+        if (faceStream)
+            for (const Rect &face : frame.faces) rectangle(frame.image, face, Scalar(0, 255, 0), 2);
+        else if (library)
+            ReferenceLibrary::draw(frame.image, frame.detections);
+        else
+            ObjectTracker::draw(frame.image, frame.result);
+        TRACE_NEXT(stage, "track.convert");
+        // 按 BGR 顺序直接包装，copy() 是唯一的一次整帧复制，不再先转换成 RGB
+        QImage image(frame.image.data, frame.image.cols, frame.image.rows, static_cast<int>(frame.image.step),
+                     QImage::Format_BGR888);
+        {
+            std::lock_guard<std::mutex> lock(frameMutex);
+            latestFrame = image.copy();
+        }
+        TRACE_END(stage);
+        // 界面还没取走上一帧时不再重复通知，避免事件队列堆积
+        if (!framePending.exchange(true)) emit frameReady();
+
+        frames++;
+        framesSinceReport++;
+        latencySum += std::chrono::duration<double, std::milli>(Clock::now() - frame.captureTime).count();
+        double elapsed = std::chrono::duration<double>(Clock::now() - lastReport).count();
+        if (elapsed >= 0.5)
+        {
+            emit statsUpdated(frames, dropped, detections, framesSinceReport / elapsed, latencySum / framesSinceReport,
+                              frame.result.found);
+            if (library)
+            {
+                QStringList names;
+                for (const LibraryDetection &d : frame.detections) names << QString::fromStdString(d.name);
+                emit objectsDetected(names);
+            }
+            lastReport = Clock::now();
+            framesSinceReport = 0;
+            latencySum = 0;
+        }
+    }
+}
@@ -0,0 +1,86 @@
+#ifndef TRACKPIPELINE_H
+#define TRACKPIPELINE_H
+
+#include <QObject>
+#include <QImage>
+#include <QStringList>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include "objecttracker.h"
+#include "referencelibrary.h"
+#include "facestream.h"
+#include "detectorregistry.h"
+#include "spscqueue.h"
+
+// 非阻塞的 ORB 追踪流水线：采集、特征提取、匹配/单应性、显示分别运行在独立线程，
+// 各级之间用无锁队列连接；下游处理不过来时只处理最新帧，过期帧直接丢弃。
+// 增量模式下跟踪稳定时特征提取线程只做灰度转换，匹配线程改用光流。
+// 人脸模式下匹配线程改为运行 FaceStreamDetector
+class TrackPipeline : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit TrackPipeline(QObject *parent = nullptr);
+    ~TrackPipeline();
+
+    bool start(const ImageFrame &ref, int camera = 0, const TrackerOptions &options = TrackerOptions());
+    bool start(std::shared_ptr<ReferenceLibrary> library, int camera = 0);  // 同时追踪参考图库中的全部目标
+    bool start(const FaceStreamOptions &options, int camera = 0);           // 视频流人脸检测
+    void stop();
+    bool isRunning() const { return running; }
+
+    QImage takeFrame();  // 取出最新一帧的显示结果（BGR888，与摄像头帧同序）
+
+signals:
+    void frameReady();
+    void statsUpdated(int frames, int dropped, int detections, double fps, double latencyMs, bool found);
+    void objectsDetected(const QStringList &names);
+    void failed(const QString &message);
+    void finished();
+
+private:
+    struct Frame
+    {
+        int index = 0;
+        Mat image;  // BGR
+        Mat gray;
+        TrackFeatures features;
+        TrackResult result;
+        std::vector<LibraryDetection> detections;  // 参考图库模式的结果
+        std::vector<Rect> faces;                   // 人脸模式的结果
+        std::chrono::steady_clock::time_point captureTime;
+    };
+
+    bool reclaim();      // 未在运行时回收上一次留下的线程，返回 false 表示仍在运行
+    bool joinThreads();  // join 全部可 join 的线程，返回是否有线程被 join
+    void launch(int camera);
+
+    void captureStage(int camera);
+    void featureStage();
+    void matchStage();
+    void displayStage();
+
+    std::unique_ptr<ObjectTracker> tracker;
+    std::shared_ptr<ReferenceLibrary> library;
+    Ptr<ORB> frameOrb;  // 参考图库模式下特征提取线程使用
+    std::unique_ptr<FaceStreamDetector> faceStream;
+    DetectorRegistry::Lease faceDetector;  // 人脸模式下只在匹配线程使用
+    std::atomic<bool> running{false};
+    std::atomic<int> dropped{0};
+    std::atomic<int> detections{0};  // 完整 ORB 检测（人脸模式下为整帧扫描）的帧数
+
+    SpscQueue<Frame> captured{4};
+    SpscQueue<Frame> featured{4};
+    SpscQueue<Frame> matched{4};
+    std::thread threads[4];
+
+    std::mutex frameMutex;
+    QImage latestFrame;
+    std::atomic<bool> framePending{false};
+};
+
+#endif // TRACKPIPELINE_H